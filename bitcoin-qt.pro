@@ -225,8 +225,11 @@ HEADERS += src/qt/bitcoingui.h \
     src/qt/motogamepage.h \
     src/endiannes.h \
     src/moto-protocol.h \
+    src/livetemplate.h \
+    src/workserver.h \
     src/moto-engine.h \
     src/moto-engine-const.h \
+    src/moto-sha512.h \
     src/qt/gamehelpdialog.h \
     src/game/debug.h
 
@@ -302,8 +305,11 @@ SOURCES += src/qt/bitcoin.cpp \
     src/qt/motogame.cpp \
     src/qt/motogamepage.cpp \
     src/bttrackers.cpp \
+    src/livetemplate.cpp \
+    src/workserver.cpp \
     src/moto-protocol.cpp \
     src/moto-engine.cpp \
+    src/moto-sha512.cpp \
     src/qt/gamehelpdialog.cpp
 
 RESOURCES += src/qt/bitcoin.qrc
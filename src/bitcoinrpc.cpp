@@ -244,6 +244,8 @@ static const CRPCCommand vRPCCommands[] =
     { "verifymessage",          &verifymessage,          false,     false,      false },
     { "getwork",                &getwork,                true,      false,      true },
     { "getworkex",              &getworkex,              true,      false,      true },
+    { "getworkserverinfo",      &getworkserverinfo,      true,      true,       false },
+    { "submitpow",              &submitpow,              true,      false,      true },
     { "listaccounts",           &listaccounts,           false,     false,      true },
     { "settxfee",               &settxfee,               false,     false,      true },
     { "getblocktemplate",       &getblocktemplate,       true,      false,      false },
@@ -0,0 +1,83 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Simulated annealing search of proof-of-play.
+//--------------------------------------------------------------------
+
+#include "anneal.hpp"
+
+// Annealing parameters.
+static const int32_t g_StartTemp = 300;
+static const int32_t g_FirstTemp = 100; // Temperature added when bike gets closer than one of thresholds.
+static const int32_t g_K = 7;           // Number of candidates evaluated in one step.
+
+CAnnealing::CAnnealing(uint64_t Seed) :
+	CSearchStrategy(Seed)
+{
+	m_Horizon = MaxHorizon;
+	m_BestInput.reset(m_Horizon);
+	randomize(&m_BestInput);
+	m_BestDistSq = ((int64_t)1) << 61;
+	m_Temp = 0;
+	m_Suggested = false;
+}
+
+void CAnnealing::start(const MotoWork& Work, const MotoWorld*, const CDistanceField*, const MotoState&)
+{
+	m_Horizon = getHorizon(Work);
+	m_BestInput.setNumFrames(m_Horizon);
+	m_BestDistSq = ((int64_t)1) << 61;
+	m_Temp = g_StartTemp;
+	m_Suggested = false;
+}
+
+void CAnnealing::suggest(const MotoPoW& PoW)
+{
+	// Annealing follows single candidate, so only the most similar solution is used.
+	if (m_Suggested)
+		return;
+	m_BestInput.assign(PoW, m_Horizon);
+	m_Suggested = true;
+}
+
+int CAnnealing::beginStep()
+{
+	m_Temp--;
+	if (m_Temp <= 0)
+		return 0;
+
+	// Spend more effort on worlds where we are already close to finish.
+	if (m_BestDistSq < CloseDistSq)
+		return 4*g_K;
+	if (m_BestDistSq < NearDistSq)
+		return 2*g_K;
+	return g_K;
+}
+
+void CAnnealing::propose(MotoPoW* pPoW)
+{
+	m_Input = m_BestInput;
+	mutate(&m_Input, m_Temp);
+	m_Input.getPoW(pPoW);
+}
+
+void CAnnealing::receive(int64_t DistSq)
+{
+	if (DistSq >= m_BestDistSq)
+		return;
+
+	// Reheat each time when we get through one of thresholds.
+	if (DistSq < NearDistSq && m_BestDistSq > NearDistSq)
+		m_Temp += g_FirstTemp;
+	if (DistSq < CloseDistSq && m_BestDistSq > CloseDistSq)
+		m_Temp += g_FirstTemp;
+	if (DistSq < VeryCloseDistSq && m_BestDistSq > VeryCloseDistSq)
+		m_Temp += g_FirstTemp;
+
+	m_BestDistSq = DistSq;
+	m_BestInput = m_Input;
+}
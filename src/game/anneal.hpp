@@ -0,0 +1,40 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Simulated annealing search of proof-of-play.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_ANNEAL_H
+#define MOTOGAME_ANNEAL_H
+
+#include "search.hpp"
+
+// Each candidate is made by mutating best input, shift amplitude decreases with temperature.
+class CAnnealing : public CSearchStrategy
+{
+public:
+	explicit CAnnealing(uint64_t Seed);
+
+	const char* getName() const { return "annealing"; }
+	void start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame);
+	void suggest(const MotoPoW& PoW);
+	int beginStep();
+	void propose(MotoPoW* pPoW);
+	void receive(int64_t DistSq);
+	int64_t getBound() const { return m_BestDistSq; }
+	int32_t getTemperature() const { return m_Temp; }
+
+private:
+	int16_t m_Horizon;
+	CInput m_Input;
+	CInput m_BestInput;
+	int64_t m_BestDistSq;
+	int32_t m_Temp;
+	bool m_Suggested;
+};
+
+#endif // MOTOGAME_ANNEAL_H
@@ -0,0 +1,134 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Beam search of proof-of-play over time.
+//--------------------------------------------------------------------
+
+#include <algorithm>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "../moto-engine-const.h"
+#include "beam.hpp"
+
+static bool isCloser(const CBeamSearch::CNode& A, const CBeamSearch::CNode& B)
+{
+	return A.DistSq < B.DistSq;
+}
+
+// States with the same key are considered duplicates, only the first one is kept.
+// Position is quantized to 1/512 of the world, velocity to 2^20 (about 1/4 of maximum bike step).
+static uint64_t getKey(const MotoState& State)
+{
+	uint64_t Key = (uint32_t)State.Bike.Pos[0] >> 23;
+	Key = (Key << 9) | ((uint32_t)State.Bike.Pos[1] >> 23);
+	Key = (Key << 12) | ((State.Bike.Vel[0] >> 20) & 0xfff);
+	Key = (Key << 12) | ((State.Bike.Vel[1] >> 20) & 0xfff);
+	return Key;
+}
+
+CBeamSearch::CBeamSearch()
+{
+	m_pWorld = NULL;
+	m_pField = NULL;
+	m_LastFrame = 0;
+}
+
+void CBeamSearch::start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame)
+{
+	m_pWorld = pWorld;
+	m_pField = pField;
+	m_LastFrame = getHorizon(Work);
+
+	CNode First;
+	First.State = FirstFrame;
+	motoInitPoW(&First.PoW);
+	First.DistSq = pField->getDistSq(FirstFrame.Bike.Pos, FirstFrame.finishDistSq);
+	m_Beam.assign(1, First);
+}
+
+int32_t CBeamSearch::getTemperature() const
+{
+	if (m_Beam.empty())
+		return 0;
+	return (m_LastFrame - m_Beam[0].State.iFrame + Interval - 1)/Interval;
+}
+
+// Apply input to copy of the node and simulate it until the end of step, dead children are dropped.
+// Returns number of simulated frames.
+int CBeamSearch::expand(const CNode& Node, int16_t NumFrames, EMotoAccel Accel, EMotoRot Rotation, EMotoResult* pResult)
+{
+	m_Children.push_back(Node);
+	CNode& Child = m_Children.back();
+	*pResult = motoAdvance(&Child.State, &Child.PoW, m_pWorld, Accel, Rotation, 1);
+	if (*pResult == MOTO_CONTINUE)
+		*pResult = motoAdvance(&Child.State, &Child.PoW, m_pWorld, Accel, MOTO_NO_ROTATION, NumFrames - 1);
+	int NumSimulated = Child.State.iFrame - Node.State.iFrame;
+	if (*pResult == MOTO_FAILURE)
+		m_Children.pop_back();
+	else
+		Child.DistSq = m_pField->getDistSq(Child.State.Bike.Pos, Child.State.finishDistSq);
+	return NumSimulated;
+}
+
+bool CBeamSearch::simulateStep(EBruteResult* pResult, MotoPoW* pPoW, MotoState* pFrame, int* pNumCandidates, int* pNumFrames)
+{
+	*pResult = BRUTE_EXHAUSTED;
+	*pNumCandidates = 0;
+	*pNumFrames = 0;
+	if (getTemperature() <= 0)
+		return true;
+
+	// All states of the beam are at the same frame.
+	int16_t NumFrames = min<int>(Interval, m_LastFrame - m_Beam[0].State.iFrame);
+	m_Children.clear();
+	for (const CNode& Node : m_Beam)
+	{
+		EMotoAccel PrevAccel = (Node.PoW.NumUpdates == 0) ? MOTO_IDLE : (EMotoAccel)(Node.PoW.Updates[Node.PoW.NumUpdates - 1] % 4);
+		bool CanChange = Node.PoW.NumUpdates < MOTO_MAX_INPUTS;
+		bool CanRotate = CanChange && Node.State.iFrame - Node.State.iLastRotate >= g_RotationPeriod;
+		for (int a = MOTO_IDLE; a <= MOTO_BRAKE; a++)
+		{
+			EMotoAccel Accel = (EMotoAccel)a;
+			for (int r = MOTO_NO_ROTATION; r <= MOTO_ROTATE_CCW; r++)
+			{
+				EMotoRot Rotation = (EMotoRot)r;
+				if (Rotation != MOTO_NO_ROTATION && !CanRotate)
+					continue;
+				if (Accel != PrevAccel && !CanChange)
+					continue;
+
+				EMotoResult Result;
+				*pNumFrames += expand(Node, NumFrames, Accel, Rotation, &Result);
+				(*pNumCandidates)++;
+				if (Result == MOTO_SUCCESS)
+				{
+					*pPoW = m_Children.back().PoW;
+					*pFrame = m_Children.back().State;
+					*pResult = BRUTE_SUCCESS;
+					return true;
+				}
+			}
+		}
+	}
+
+	// Closest children that are not duplicates of even closer ones become next beam.
+	sort(m_Children.begin(), m_Children.end(), isCloser);
+	m_Beam.clear();
+	m_Keys.clear();
+	for (size_t i = 0; i < m_Children.size() && (int)m_Beam.size() < Width; i++)
+		if (m_Keys.insert(getKey(m_Children[i].State)).second)
+			m_Beam.push_back(m_Children[i]);
+
+	if (m_Beam.empty())
+		return true;
+
+	*pPoW = m_Beam[0].PoW;
+	*pFrame = m_Beam[0].State;
+	*pResult = BRUTE_CONTINUE;
+	return true;
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Beam search of proof-of-play over time.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_BEAM_H
+#define MOTOGAME_BEAM_H
+
+#include <unordered_set>
+#include <vector>
+
+#include "search.hpp"
+
+// Keeps states closest to finish and expands each of them with all inputs once per interval.
+// States are resumed, so no frame is simulated twice.
+class CBeamSearch : public CSearchStrategy
+{
+public:
+	static const int Width = 48;         // Number of states kept after each step.
+	static const int16_t Interval = 150; // Frames between input changes.
+
+	CBeamSearch();
+
+	const char* getName() const { return "beam"; }
+	void start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame);
+	bool simulateStep(EBruteResult* pResult, MotoPoW* pPoW, MotoState* pFrame, int* pNumCandidates, int* pNumFrames);
+	int32_t getTemperature() const;
+
+	struct CNode
+	{
+		MotoState State;
+		MotoPoW PoW;
+		int64_t DistSq;
+	};
+
+private:
+	const MotoWorld* m_pWorld;
+	const CDistanceField* m_pField;
+	int16_t m_LastFrame;
+	std::vector<CNode> m_Beam;
+	std::vector<CNode> m_Children;
+	std::unordered_set<uint64_t> m_Keys;
+
+	int expand(const CNode& Node, int16_t NumFrames, EMotoAccel Accel, EMotoRot Rotation, EMotoResult* pResult);
+};
+
+#endif // MOTOGAME_BEAM_H
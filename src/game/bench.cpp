@@ -0,0 +1,273 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Engine benchmarks. All workloads are fixed (recorded solutions and
+// seeded pseudo-random input), so results of different builds and
+// hosts are comparable. Each benchmark prints one line of JSON.
+//--------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+#include "../moto-engine.h"
+#include "../moto-protocol.h"
+#include "brute.hpp"
+
+// Solutions found by motosolver, in the same format as it prints them.
+static const char* g_pRecorded[] =
+{
+	"***WPoW:0100983a7465737400000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000e7eee7615ef35f30e49b482e15cae75007201e12617b0feda7e1647796ff022bea8ed02a82a175930f2337cd3794c52208006d6b1af0c0cbd625658aac2c9faa07d13c447e33051eeef95a602c6ea20fe31a14009611f6067d050d08190e2111f6086603aa0ac20ebe203106c10d2910f13e850d9e0c2e009a126e11a6293d09a111faffd50c00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a7465737400000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000f289b349c305bff78ceb74004ae1bc53ad6b1e6626accf2c091f722ed8e339d845a0531a572acdd6f0f4c40f2a6285b6b9c59e3a8178abbabe5b0ec3dc100d71da16c66834705b278c12dd8d1a9dbc0ff6160f00961112035d01f108e912f9154913090ee50e950c3510e516f2187e1289020a46da02e1194100e10c6d160100cd16090001130e007d02000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a746573740000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000084945f764b735f42246d960fdc40078d4b2b86e6df4783b677f9dbbadca03cb186e545e1e35a96675bb681beeb868fca42fb787863bb4325dcedc701d9167348fee38151d380b367bf4679fefa5cb23b780e0d009611a2033d0c4515290dd911b919a10c36083a0fcd060509f509fa16b206f109f92059137d0fdd0ce5119923851d890fa213391b0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a7465737400000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000367e8a829525e69beecbc93c8672a1b785b84c528c5405233eac0e2a8c68c3cee03039ba5c30f9638ae76ff89082343e2d8e8f3c0e52d23a2fd9f556c5e99ef8ebdfd53083f2c978e6fa224977402d20d1110e0096110502920fb202ae0a06132a19660f6e1a3e115a126e148d04910add0c1922c51c8d2619200200f50c02008a163a18000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a74657374000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000006a0512507a081c4bbc7a3badeeb68fc886b07569b5a0729cd776e9d6fa28ecb8e0a1e6cf21fb096447580892fd4d333bca1825ef97cd765bb528789e9f54a2c6f3ace2258bf2483bfcc7c0079d9994268e0e0a009611d614b509210fed0b35150a107603f10f352811107d0a760d4611a6118a0f790045182d2351253912950d051a710b150d00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a7465737400000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000b9f0f691d574e402d184797105979aab489e0b70810a4e0eede997729eb984d72cb2fdd8589616902a03bf78fa4f9e9ba2ebe82154f606e3fb07f33ee828ff0b4976cfbd1016cca3f42474a3a434ed18b90d0c009611060f0a0c0e13c50b9a0aca067a11c505e906d509a50919199110f9366516b10b491f2913bd0cbd0f6e1afd188504090000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a7465737400000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000d49bbb94598e380d7fc4d681a2cd461f47644d6ba93f239ed129f248d1ac09ddbe1ab519f4bf02cf7a3b6d7fb81d88208d6242809db2a357aa308bab0419b209ef8bf21b659e8426f80a46ce2d006f468918100096113e01590589049911dd1f3912650fa9144d122d23c120150bee04f6070e160628f20a6103022106005511292ba10a7a2000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+	"***WPoW:0100983a74657374000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000005c3ee5ab7a65fafc5df597ea8764813ca65978567966bb67fc6e998703afcf70cfb18b8a9b3a90f44afd526169df43d0f5336784adf02dfb4bf44dfa287f2fb468c903442cf4cccf5cc5d542e2b4a216321d13009611b9261500a60a5e0036167d02a1093537111eed0fb111910ab90f210b31164a03ea22a21f711686097d030906d519e20cde0c0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+};
+
+static const int g_NumRecorded = sizeof(g_pRecorded)/sizeof(g_pRecorded[0]);
+
+static const int g_NumFramesCandidates = 2048;
+static const int g_NumCheckRounds = 16;
+static const int g_NumGoodWorlds = 16;
+static const uint64_t g_NumSearchCandidates = 5000;
+static const int16_t g_TotalFrames = 30*250;
+
+static uint32_t g_Seed = 1;
+static int g_NumReps = 5;
+static const char* g_pOnly = NULL;
+
+static vector<MotoWork> g_Works;
+static vector<MotoPoW> g_PoWs;
+
+// Small generator of our own, so that workload doesn't depend on rand() of C library.
+static uint32_t g_Random;
+
+static uint32_t nextRandom()
+{
+	g_Random ^= g_Random << 13;
+	g_Random ^= g_Random >> 17;
+	g_Random ^= g_Random << 5;
+	return g_Random;
+}
+
+static void seedRandom(uint32_t Seed)
+{
+	g_Random = Seed*2654435761u + 1;
+	for (int i = 0; i < 8; i++)
+		nextRandom();
+}
+
+// Print result in the format that can be parsed by scripts.
+static void report(const char* pName, const char* pUnit, uint64_t Count, double Seconds)
+{
+	printf("{\"benchmark\":\"%s\",\"unit\":\"%s\",\"seed\":%u,\"reps\":%d,\"count\":%llu,\"seconds\":%.6f,\"rate\":%.1f}\n",
+		pName, pUnit, g_Seed, g_NumReps, (unsigned long long)Count, Seconds, Seconds > 0 ? Count/Seconds : 0.0);
+	fflush(stdout);
+}
+
+// Run benchmark several times and report the fastest run, it is the least disturbed by other processes.
+// Work must do the same amount of work each time and return its size.
+template<typename T>
+static void run(const char* pName, const char* pUnit, T Work)
+{
+	if (g_pOnly && strcmp(g_pOnly, pName) != 0)
+		return;
+
+	uint64_t Count = 0;
+	double Best = 0;
+	for (int i = 0; i < g_NumReps; i++)
+	{
+		steady_clock::time_point Start = steady_clock::now();
+		Count = Work();
+		double Seconds = duration_cast<duration<double>>(steady_clock::now() - Start).count();
+		if (i == 0 || Seconds < Best)
+			Best = Seconds;
+	}
+	report(pName, pUnit, Count, Best);
+}
+
+// Random input that looks like input of annealing: changes every few seconds and respects rotation period.
+static void randomPoW(MotoPoW* pPoW)
+{
+	MotoState Frame;
+	motoInitPoW(pPoW);
+	pPoW->NumFrames = g_TotalFrames;
+	Frame.iFrame = 0;
+	int LastRotation = -1000;
+	EMotoAccel Accel = MOTO_GAS_RIGHT;
+	while (true)
+	{
+		Frame.iFrame += 1 + nextRandom() % 300;
+		if (Frame.iFrame >= g_TotalFrames)
+			break;
+
+		EMotoRot Rotation = MOTO_NO_ROTATION;
+		if (Frame.iFrame - LastRotation > 201 && nextRandom() % 2)
+		{
+			Rotation = (nextRandom() % 2) ? MOTO_ROTATE_CW : MOTO_ROTATE_CCW;
+			LastRotation = Frame.iFrame;
+		}
+		if (nextRandom() % 3 == 0)
+			Accel = (Accel == MOTO_GAS_RIGHT) ? MOTO_GAS_LEFT : MOTO_GAS_RIGHT;
+		if (!recordInput(pPoW, &Frame, Accel, Rotation))
+			break;
+	}
+}
+
+static bool loadRecorded()
+{
+	for (int i = 0; i < g_NumRecorded; i++)
+	{
+		MotoWork Work;
+		MotoPoW PoW;
+		if (!motoParseMessage(g_pRecorded[i], Work, PoW))
+			return false;
+		g_Works.push_back(Work);
+		g_PoWs.push_back(PoW);
+	}
+	return true;
+}
+
+// World and input for frames benchmark, prepared once.
+static MotoWorld g_World;
+static MotoState g_FirstFrame;
+static vector<MotoPoW> g_Candidates;
+
+static void prepareFrames()
+{
+	MotoPoW PoW;
+	motoInitPoW(&PoW);
+	PoW.Nonce = g_Seed;
+	while (!motoGenerateGoodWorld(&g_World, &g_FirstFrame, g_Works[0].Block, &PoW))
+		PoW.Nonce++;
+
+	seedRandom(g_Seed);
+	g_Candidates.resize(g_NumFramesCandidates);
+	for (int i = 0; i < g_NumFramesCandidates; i++)
+	{
+		randomPoW(&g_Candidates[i]);
+		g_Candidates[i].Nonce = PoW.Nonce;
+	}
+}
+
+// Frames simulated by motoReplay, almost all time is spent in advanceOneFrame.
+static uint64_t benchFrames()
+{
+	uint64_t NumFrames = 0;
+	for (int i = 0; i < g_NumFramesCandidates; i++)
+	{
+		MotoState Frame = g_FirstFrame;
+		MotoPoW Candidate = g_Candidates[i];
+		motoReplay(&Frame, &Candidate, &g_World, g_TotalFrames);
+		NumFrames += Frame.iFrame;
+	}
+	return NumFrames;
+}
+
+// Complete check of recorded solutions, including world generation.
+static uint64_t benchCheck()
+{
+	for (int r = 0; r < g_NumCheckRounds; r++)
+		for (int i = 0; i < g_NumRecorded; i++)
+		{
+			MotoPoW PoW = g_PoWs[i];
+			if (!motoCheck(g_Works[i].Block, &PoW))
+			{
+				fprintf(stderr, "Error: recorded solution %d is rejected by motoCheck.\n", i);
+				exit(1);
+			}
+		}
+	return g_NumCheckRounds*g_NumRecorded;
+}
+
+// Well-formed worlds found by trying consecutive nonces, the way solver finds them.
+static uint64_t benchWorlds()
+{
+	MotoWorld World;
+	MotoState FirstFrame;
+	MotoPoW PoW;
+	motoInitPoW(&PoW);
+	PoW.Nonce = g_Seed;
+	for (int i = 0; i < g_NumGoodWorlds; i++)
+	{
+		while (!motoGenerateGoodWorld(&World, &FirstFrame, g_Works[i % g_NumRecorded].Block, &PoW))
+			PoW.Nonce++;
+		PoW.Nonce++;
+	}
+	return g_NumGoodWorlds;
+}
+
+// Candidates evaluated by search strategy, moving to next world when temperature is over.
+static uint64_t benchSearch(const char* pStrategy)
+{
+	CBruteForce Brute(createSearchStrategy(pStrategy, g_Seed));
+	MotoWorld World;
+	MotoState FirstFrame;
+	MotoPoW PoW;
+	motoInitPoW(&PoW);
+	PoW.Nonce = g_Seed;
+
+	// Time target is the same for all solutions.
+	const MotoWork& Work = g_Works[0];
+	while (Brute.getNumCandidates() < g_NumSearchCandidates)
+	{
+		while (!motoGenerateGoodWorld(&World, &FirstFrame, Work.Block, &PoW))
+			PoW.Nonce++;
+
+		Brute.start(Work, World, FirstFrame, PoW.Nonce);
+		while (Brute.getNumCandidates() < g_NumSearchCandidates && Brute.step() == BRUTE_CONTINUE)
+			;
+		PoW.Nonce++;
+	}
+	return Brute.getNumCandidates();
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "-seed=", 6) == 0)
+			g_Seed = strtoul(argv[i] + 6, NULL, 10);
+		else if (strncmp(argv[i], "-reps=", 6) == 0)
+			g_NumReps = atoi(argv[i] + 6);
+		else if (strncmp(argv[i], "-only=", 6) == 0)
+			g_pOnly = argv[i] + 6;
+		else
+		{
+			fprintf(stderr, "Usage: motobench [-seed=N] [-reps=N] [-only=frames|check|worlds|annealing|genetic]\n");
+			return 1;
+		}
+	}
+	if (g_NumReps < 1)
+		g_NumReps = 1;
+
+	// Engine prints debug messages to cout, keep them out of results.
+	cout.rdbuf(cerr.rdbuf());
+
+	if (!loadRecorded())
+	{
+		fprintf(stderr, "Error: failed to parse recorded solutions.\n");
+		return 1;
+	}
+
+	prepareFrames();
+	run("frames", "frames/s", benchFrames);
+	run("check", "replays/s", benchCheck);
+	run("worlds", "worlds/s", benchWorlds);
+	run("annealing", "candidates/s", []() { return benchSearch("annealing"); });
+	run("genetic", "candidates/s", []() { return benchSearch("genetic"); });
+	return 0;
+}
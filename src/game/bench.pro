@@ -0,0 +1,53 @@
+#-------------------------------------------------
+#
+# Engine benchmarks, don't need OpenGL nor GLFW.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = motobench
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += \
+    sha512.cpp \
+    brute.cpp \
+    search.cpp \
+    input.cpp \
+    anneal.cpp \
+    genetic.cpp \
+    beam.cpp \
+    field.cpp \
+    bench.cpp \
+    ../moto-engine.cpp \
+    ../moto-sha512.cpp \
+    ../moto-protocol.cpp
+
+HEADERS += \
+    brute.hpp \
+    search.hpp \
+    input.hpp \
+    random.hpp \
+    anneal.hpp \
+    genetic.hpp \
+    beam.hpp \
+    field.hpp \
+    ../moto-engine.h \
+    ../moto-sha512.h \
+    ../moto-protocol.h \
+    sha512.h \
+    debug.h
+
+OTHER_FILES += \
+    build-bench-linux.sh
+QMAKE_CXXFLAGS+=-std=c++11
+QMAKE_CXXFLAGS_DEBUG -= -O2
+
+DEFINES += NO_OPENSSL_SHA
+INCLUDEPATH += .
+
+LIBS+=-lpthread
@@ -0,0 +1,171 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Brute-force search of proof-of-play.
+//--------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#ifdef _WIN32
+    #include <malloc.h>
+#endif
+using namespace std;
+
+#include "../moto-engine.h"
+#include "brute.hpp"
+
+// Alignment of MOTO_CACHE_ALIGNED.
+static const size_t g_Alignment = 64;
+
+void* CBruteForce::operator new(size_t Size)
+{
+	void* p = NULL;
+#ifdef _WIN32
+	p = _aligned_malloc(Size, g_Alignment);
+#else
+	if (posix_memalign(&p, g_Alignment, Size) != 0)
+		p = NULL;
+#endif
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+void CBruteForce::operator delete(void* p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+CBruteForce::CBruteForce(CSearchStrategy* pStrategy) :
+	m_pStrategy(pStrategy ? pStrategy : createSearchStrategy("annealing", 0))
+{
+	memset(&m_World, 0, sizeof(m_World));
+	memset(&m_FirstFrame, 0, sizeof(m_FirstFrame));
+	m_Frame = m_FirstFrame;
+	motoInitPoW(&m_PoW);
+	m_BestDistSq = ((int64_t)1) << 61;
+	m_NumCandidates = 0;
+	m_NumFrames = 0;
+	m_Horizon = CSearchStrategy::MaxHorizon;
+	m_pEpoch = NULL;
+	m_Epoch = 0;
+	m_BestPoW = m_PoW;
+	m_NumCheckpoints[0] = m_NumCheckpoints[1] = 0;
+	m_iBest = 0;
+}
+
+void CBruteForce::start(const MotoWork& Work, const MotoWorld& World, const MotoState& FirstFrame, uint32_t Nonce)
+{
+	m_World = World;
+	m_FirstFrame = FirstFrame;
+	m_Frame = FirstFrame;
+	motoInitPoW(&m_PoW);
+	m_PoW.Nonce = Nonce;
+	m_BestDistSq = ((int64_t)1) << 61;
+	m_BestPoW = m_PoW;
+	m_NumCheckpoints[m_iBest] = 0;
+	m_Field.build(&m_World);
+	m_Horizon = CSearchStrategy::getHorizon(Work);
+	m_pStrategy->start(Work, &m_World, &m_Field, FirstFrame);
+}
+
+EBruteResult CBruteForce::step()
+{
+	EBruteResult Result;
+	int NumSimulated;
+	int NumFrames;
+	uint32_t Nonce = m_PoW.Nonce;
+	if (isStale())
+		return BRUTE_CONTINUE;
+	if (m_pStrategy->simulateStep(&Result, &m_PoW, &m_Frame, &NumSimulated, &NumFrames))
+	{
+		m_PoW.Nonce = Nonce;
+		m_NumCandidates += NumSimulated;
+		m_NumFrames += NumFrames;
+		int64_t DistSq = m_Field.getDistSq(m_Frame.Bike.Pos, m_Frame.finishDistSq);
+		if (Result != BRUTE_EXHAUSTED && DistSq < m_BestDistSq)
+		{
+			m_BestDistSq = DistSq;
+			m_BestPoW = m_PoW;
+		}
+		return Result;
+	}
+
+	int K = m_pStrategy->beginStep();
+	if (K <= 0)
+		return BRUTE_EXHAUSTED;
+
+	for (int i = 0; i < K; i++)
+	{
+		// Rest of the batch is useless, world will be dropped.
+		if (isStale())
+			return BRUTE_CONTINUE;
+
+		m_pStrategy->propose(&m_PoW);
+		int64_t DistSq = replay();
+		m_NumCandidates++;
+		if (m_Frame.curState == MOTO_SUCCESS)
+			return BRUTE_SUCCESS;
+
+		if (DistSq < m_BestDistSq)
+		{
+			m_BestDistSq = DistSq;
+			m_BestPoW = m_PoW;
+			m_iBest = 1 - m_iBest;
+		}
+		m_pStrategy->receive(DistSq);
+	}
+	return BRUTE_CONTINUE;
+}
+
+// Replay current candidate starting from the latest checkpoint of best candidate that is still valid for it.
+// Returns squared distance to finish through the sky.
+int64_t CBruteForce::replay()
+{
+	const MotoState* pBest = m_Checkpoints[m_iBest];
+	MotoState* pCandidate = m_Checkpoints[1 - m_iBest];
+	int& NumCheckpoints = m_NumCheckpoints[1 - m_iBest];
+
+	// Checkpoint i is valid if updates up to i (inclusive) are the same.
+	// Update i must be the same too, because it is validated before its frame is reached.
+	int NumUpdates = min(m_PoW.NumUpdates, m_BestPoW.NumUpdates);
+	int i = 0;
+	while (i < NumUpdates && m_PoW.Updates[i] == m_BestPoW.Updates[i])
+		i++;
+	i = min(i, m_NumCheckpoints[m_iBest]) - 1;
+
+	if (i >= 0)
+	{
+		memcpy(pCandidate, pBest, i*sizeof(MotoState));
+		m_Frame = pBest[i];
+		NumCheckpoints = i;
+	}
+	else
+	{
+		m_Frame = m_FirstFrame;
+		NumCheckpoints = 0;
+	}
+
+	// Most candidates are of no interest to strategy, stop them as soon as it is certain.
+	// Distance through the sky is never less than straight one, so the bound can be checked by engine.
+	// Nothing is simulated after horizon, such candidate couldn't be a solution anyway.
+	int64_t Bound = m_pStrategy->getBound();
+	int FirstFrame = m_Frame.iFrame;
+	motoReplayBounded(&m_Frame, &m_PoW, &m_World, m_Horizon, pCandidate, &NumCheckpoints, Bound);
+	m_NumFrames += m_Frame.iFrame - FirstFrame;
+
+	// Stopped candidate has only lower bound of straight distance, it is enough to reject it.
+	if (Bound > 0 && m_Frame.finishDistSq >= Bound)
+		return m_Frame.finishDistSq;
+	return m_Field.getDistSq(m_Frame.Bike.Pos, m_Frame.finishDistSq);
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Brute-force search of proof-of-play. Candidates are proposed by
+// search strategy (see search.hpp) and replayed here.
+// It doesn't depend on rendering, so it is shared by motogame and
+// headless motosolver.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_BRUTE_H
+#define MOTOGAME_BRUTE_H
+
+#include <atomic>
+#include <memory>
+
+#include "../moto-engine.h"
+#include "search.hpp"
+#include "field.hpp"
+
+class CBruteForce
+{
+public:
+	// Takes ownership of strategy, annealing with seed 0 is used if it is NULL.
+	explicit CBruteForce(CSearchStrategy* pStrategy = NULL);
+
+	// World is cache aligned, plain operator new doesn't guarantee such alignment.
+	static void* operator new(size_t Size);
+	static void operator delete(void* p);
+
+	// Start search in new world.
+	void start(const MotoWork& Work, const MotoWorld& World, const MotoState& FirstFrame, uint32_t Nonce);
+
+	// Solution of similar world to start from, see CSearchStrategy::suggest().
+	void suggest(const MotoPoW& PoW) { m_pStrategy->suggest(PoW); }
+
+	// Search is stale when *pEpoch differs from Epoch (e.g. new block was found). Then step() stops
+	// after the candidate that is being replayed, so stale work is abandoned within MaxHorizon frames,
+	// and returns BRUTE_CONTINUE. NULL disables the check.
+	void setEpoch(const std::atomic<unsigned int>* pEpoch, unsigned int Epoch) { m_pEpoch = pEpoch; m_Epoch = Epoch; }
+	bool isStale() const { return m_pEpoch && m_pEpoch->load(std::memory_order_relaxed) != m_Epoch; }
+
+	// Evaluate one batch of candidates.
+	EBruteResult step();
+
+	// Current candidate. After BRUTE_SUCCESS this is the solution.
+	const MotoPoW& getPoW() const { return m_PoW; }
+
+	// Best candidate found in current world.
+	const MotoPoW& getBestPoW() const { return m_BestPoW; }
+
+	// Last simulated frame of last candidate.
+	const MotoState& getFrame() const { return m_Frame; }
+
+	// Distance field of current world.
+	const CDistanceField& getField() const { return m_Field; }
+
+	int32_t getTemperature() const { return m_pStrategy->getTemperature(); }
+	int64_t getBestDistSq() const { return m_BestDistSq; }
+	const char* getStrategyName() const { return m_pStrategy->getName(); }
+
+	// Number of candidates evaluated and frames simulated since construction.
+	uint64_t getNumCandidates() const { return m_NumCandidates; }
+	uint64_t getNumFrames() const { return m_NumFrames; }
+
+private:
+	std::unique_ptr<CSearchStrategy> m_pStrategy;
+
+	MotoWorld m_World;
+	MotoState m_FirstFrame;
+	MotoState m_Frame;
+	MotoPoW m_PoW;
+	CDistanceField m_Field;
+	int64_t m_BestDistSq;
+	uint64_t m_NumCandidates;
+	uint64_t m_NumFrames;
+	int16_t m_Horizon;
+	const std::atomic<unsigned int>* m_pEpoch;
+	unsigned int m_Epoch;
+
+	// States at each input update of best candidate and of current one.
+	// Candidate is replayed from the last state that it shares with best candidate.
+	MotoPoW m_BestPoW;
+	MotoState m_Checkpoints[2][MOTO_MAX_INPUTS];
+	int m_NumCheckpoints[2];
+	int m_iBest;
+
+	int64_t replay();
+};
+
+#endif // MOTOGAME_BRUTE_H
@@ -3,4 +3,4 @@
 CXX=g++
 #CXX=clang++
 
-$CXX -O2 -s -std=c++0x -fopenmp -DNO_OPENSSL_SHA sha512.cpp ../moto-engine.cpp ../moto-protocol.cpp game.cpp graphics.cpp render.cpp -I../ -I/usr/include/ -lGL -lGLEW -lglfw3 -lX11 -lXxf86vm -lXrandr -lXi -lpthread -o motogame
\ No newline at end of file
+$CXX -O2 -s -std=c++0x -fopenmp -DNO_OPENSSL_SHA sha512.cpp ../moto-engine.cpp ../moto-sha512.cpp ../moto-protocol.cpp brute.cpp search.cpp input.cpp anneal.cpp genetic.cpp beam.cpp field.cpp game.cpp graphics.cpp render.cpp -I../ -I/usr/include/ -lGL -lGLEW -lglfw3 -lX11 -lXxf86vm -lXrandr -lXi -lpthread -o motogame
\ No newline at end of file
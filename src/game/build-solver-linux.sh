@@ -0,0 +1,6 @@
+#!/bin/sh
+
+CXX=g++
+#CXX=clang++
+
+$CXX -O2 -s -std=c++0x -DNO_OPENSSL_SHA sha512.cpp ../moto-engine.cpp ../moto-sha512.cpp ../moto-protocol.cpp brute.cpp search.cpp input.cpp anneal.cpp genetic.cpp beam.cpp field.cpp portfolio.cpp library.cpp tempering.cpp telemetry.cpp solver.cpp -I../ -I. -lpthread -o motosolver
\ No newline at end of file
@@ -0,0 +1,6 @@
+#!/bin/sh
+
+CXX=g++
+#CXX=clang++
+
+$CXX -O2 -s -std=c++0x telemetry.cpp stats.cpp -I../ -I. -o motostats
\ No newline at end of file
@@ -0,0 +1,149 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Distance to finish through the sky, used as fitness by search.
+//--------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "field.hpp"
+
+static const uint32_t g_Unreachable = 0xFFFFFFFF;
+static const int g_CellShift = 24;                  // Cell size is 2^24 in integer coordinates.
+static const uint32_t g_StepDist = 1000;            // Path length between neighbor cells.
+static const uint32_t g_DiagonalStepDist = 1414;
+
+static int wrap(int i)
+{
+	return i & (CDistanceField::Size - 1);
+}
+
+static int getIndex(int i, int j)
+{
+	return wrap(i)*CDistanceField::Size + wrap(j);
+}
+
+CDistanceField::CDistanceField() :
+	m_Dist(Size*Size, g_Unreachable)
+{
+}
+
+void CDistanceField::build(const MotoWorld* pWorld)
+{
+	// Sample terrain function at cell centers, same test as ground collision uses.
+	vector<bool> Sky(Size*Size);
+	for (int i = 0; i < Size; i++)
+		for (int j = 0; j < Size; j++)
+		{
+			float Fdxdy[3];
+			motoF(Fdxdy, (i + 0.5f)/Size, (j + 0.5f)/Size, pWorld);
+			Sky[getIndex(i, j)] = Fdxdy[2]*8192 <= MOTO_LEVEL;
+		}
+
+	// Bike doesn't fit into passages that are only one cell wide, so cells next to rock are not used.
+	vector<bool> Free(Size*Size);
+	for (int i = 0; i < Size; i++)
+		for (int j = 0; j < Size; j++)
+			Free[getIndex(i, j)] = Sky[getIndex(i, j)] && Sky[getIndex(i - 1, j)] && Sky[getIndex(i + 1, j)] && Sky[getIndex(i, j - 1)] && Sky[getIndex(i, j + 1)];
+
+	// Dijkstra from finish over 8 neighbors, diagonal steps are not allowed to cut corners of rock.
+	fill(m_Dist.begin(), m_Dist.end(), g_Unreachable);
+	typedef pair<uint32_t, int> CEntry;
+	priority_queue<CEntry, vector<CEntry>, greater<CEntry> > Queue;
+	int Finish = getIndex((uint32_t)g_MotoFinish[0] >> g_CellShift, (uint32_t)g_MotoFinish[1] >> g_CellShift);
+	m_Dist[Finish] = 0;
+	Queue.push(CEntry(0, Finish));
+	while (!Queue.empty())
+	{
+		CEntry Entry = Queue.top();
+		Queue.pop();
+		if (Entry.first != m_Dist[Entry.second])
+			continue;
+
+		int i = Entry.second/Size;
+		int j = Entry.second%Size;
+		for (int di = -1; di <= 1; di++)
+			for (int dj = -1; dj <= 1; dj++)
+			{
+				int Next = getIndex(i + di, j + dj);
+				if ((di == 0 && dj == 0) || !Free[Next])
+					continue;
+				if (di != 0 && dj != 0 && !(Free[getIndex(i + di, j)] && Free[getIndex(i, j + dj)]))
+					continue;
+
+				uint32_t Dist = Entry.first + ((di != 0 && dj != 0) ? g_DiagonalStepDist : g_StepDist);
+				if (Dist < m_Dist[Next])
+				{
+					m_Dist[Next] = Dist;
+					Queue.push(CEntry(Dist, Next));
+				}
+			}
+	}
+}
+
+int64_t CDistanceField::getDistSq(const int32_t Pos[2], int64_t StraightDistSq) const
+{
+	// Path through the best of four surrounding cell centers, the last piece is straight.
+	// Coordinates are scaled down by 16 to avoid overflow.
+	int i0 = (uint32_t)(Pos[0] - (1 << (g_CellShift - 1))) >> g_CellShift;
+	int j0 = (uint32_t)(Pos[1] - (1 << (g_CellShift - 1))) >> g_CellShift;
+	int64_t MinDist = -1;
+	for (int di = 0; di <= 1; di++)
+		for (int dj = 0; dj <= 1; dj++)
+		{
+			uint32_t CellDist = m_Dist[getIndex(i0 + di, j0 + dj)];
+			if (CellDist == g_Unreachable)
+				continue;
+
+			uint32_t Center[2] = { ((uint32_t)wrap(i0 + di) << g_CellShift) + (1 << (g_CellShift - 1)), ((uint32_t)wrap(j0 + dj) << g_CellShift) + (1 << (g_CellShift - 1)) };
+			int64_t dx = (int32_t)((uint32_t)Pos[0] - Center[0]) >> 4;
+			int64_t dy = (int32_t)((uint32_t)Pos[1] - Center[1]) >> 4;
+			int64_t Dist = (((int64_t)CellDist << (g_CellShift - 4))/g_StepDist) + (int64_t)sqrt((double)(dx*dx + dy*dy));
+			if (MinDist < 0 || Dist < MinDist)
+				MinDist = Dist;
+		}
+	if (MinDist < 0)
+		return StraightDistSq;
+
+	// finishDistSq is about (distance^2)/2^35.
+	return max((MinDist*MinDist) >> 27, StraightDistSq);
+}
+
+void CDistanceField::getPath(const int32_t Pos[2], int MaxCells, vector<pair<int, int> >* pPath) const
+{
+	pPath->clear();
+	int i = (uint32_t)Pos[0] >> g_CellShift;
+	int j = (uint32_t)Pos[1] >> g_CellShift;
+	if (m_Dist[getIndex(i, j)] == g_Unreachable)
+		return;
+
+	// Each step goes to the neighbor closest to finish, it is always closer than current cell.
+	while ((int)pPath->size() < MaxCells)
+	{
+		pPath->push_back(make_pair(i, j));
+		uint32_t Dist = m_Dist[getIndex(i, j)];
+		if (Dist == 0)
+			break;
+
+		int NextI = i, NextJ = j;
+		for (int di = -1; di <= 1; di++)
+			for (int dj = -1; dj <= 1; dj++)
+				if (m_Dist[getIndex(i + di, j + dj)] < Dist)
+				{
+					Dist = m_Dist[getIndex(i + di, j + dj)];
+					NextI = wrap(i + di);
+					NextJ = wrap(j + dj);
+				}
+		i = NextI;
+		j = NextJ;
+	}
+}
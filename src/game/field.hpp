@@ -0,0 +1,44 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Distance to finish through the sky, used as fitness by search.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_FIELD_H
+#define MOTOGAME_FIELD_H
+
+#include <utility>
+#include <vector>
+
+#include "../moto-engine.h"
+
+// Grid over the whole world (it wraps around in both directions) with length of
+// the shortest path from center of each sky cell to finish that doesn't cross terrain.
+class CDistanceField
+{
+public:
+	static const int Size = 256; // Cells in each direction.
+
+	CDistanceField();
+
+	void build(const MotoWorld* pWorld);
+
+	// Squared distance from Pos to finish in the same units as MotoState::finishDistSq.
+	// It is never less than StraightDistSq (finishDistSq at Pos), which is also returned
+	// if Pos is not near any cell connected to finish.
+	int64_t getDistSq(const int32_t Pos[2], int64_t StraightDistSq) const;
+
+	// Cells (i, j) of the shortest path from the cell of Pos to finish, at most MaxCells of them.
+	// Path is empty if Pos is not in a cell connected to finish.
+	void getPath(const int32_t Pos[2], int MaxCells, std::vector<std::pair<int, int> >* pPath) const;
+
+private:
+	// Path length in units of 1/1000 of cell, Unreachable for rock and for sky cut off from finish.
+	std::vector<uint32_t> m_Dist;
+};
+
+#endif // MOTOGAME_FIELD_H
@@ -21,6 +21,7 @@
 #include <future>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <mutex>
@@ -38,6 +39,8 @@ using namespace chrono;
 #include "vec2.hpp"
 #include "graphics.hpp"
 #include "render.hpp"
+#include "brute.hpp"
+#include "random.hpp"
 #include <unistd.h>
 
 //static bool g_isRender=true
@@ -46,6 +49,10 @@ using namespace chrono;
 static thread g_InputThread;
 static vector<string> g_InputLines;
 static mutex g_InputMutex;
+
+// Incremented by input thread when new block is found, brute stops at once instead of finishing its batch.
+// It is incremented together with adding work to g_InputLines, so brute started after parseInput() is never stale.
+static atomic<unsigned int> g_InputEpoch(0);
 int g_success=0;
 
 // View properties.
@@ -69,24 +76,8 @@ static MotoState g_FirstFrame;
 static MotoState g_Frame;
 static MotoPoW   g_PoW;
 
-const int g_rotateRightCnt=15;
-const int g_rotateLeftCnt=15;
-const int g_switchCnt=5;
-const int g_commandsCnt=g_rotateRightCnt+g_rotateLeftCnt+g_switchCnt;
-int64_t g_finishDistSq=((int64_t)1)<<61;
-
-static int32_t g_rotateRightPos[g_rotateRightCnt];
-static int32_t g_rotateLeftPos[g_rotateLeftCnt];
-static int32_t g_switchPos[g_switchCnt];
-//static int32_t g_startTemp=1000;
-static int32_t g_startTemp=300;
-static int32_t g_k=7;
-//static int32_t g_firstTemp=700;
-static int32_t g_firstTemp=100;
-static int32_t g_temp=0;
-//static int32_t g_totalFrames=18.46*250;
-static int32_t g_totalFrames=30
-        *250;
+static CBruteForce g_Brute;
+static CRandom g_Random;
 
 static bool g_HasNextWork = false;
 static bool g_PlayingForFun = true;
@@ -106,30 +97,6 @@ static enum
     STATE_BRUTE
 } g_State;
 
-static int randLim(int lim){
-    return lim>0?rand()%lim:0;
-}
-
-struct Command
-{
-    int32_t time;
-    EMotoRot rotation;
-    EMotoAccel acceleration;
-
-
-    Command(EMotoRot r) : rotation(r) {time=randLim(g_totalFrames);acceleration=MOTO_IDLE;}
-    Command(EMotoAccel ac) : acceleration(ac) {rotation=MOTO_NO_ROTATION;}
-    Command(){}
-};
-
-struct less_than_time
-{
-    inline bool operator() (const Command& struct1, const Command& struct2)
-    {
-        return (struct1.time < struct2.time);
-    }
-};
-
 static bool g_MotoDir = false;
 
 static double g_PrevTime;
@@ -138,67 +105,6 @@ static double g_ProgramStartTime;
 
 static GLFWwindow* g_pWindow;
 
-static Command g_commands[g_commandsCnt];
-static Command g_bestCommands[g_commandsCnt];
-
-
-static int g_rotationPeriod=200;
-
-static void updatePow(){
-
-    MotoState tmpFrame;
-    EMotoAccel accel=MOTO_GAS_RIGHT;
-    EMotoRot rotation;
-    int last_rotation=0;
-    int last_acceleration = 0;
-    g_PoW.NumUpdates = 0;
-    g_PoW.NumFrames =g_Work.TimeTarget-1;
-
-    tmpFrame.iFrame=1.5*250;
-    recordInput(&g_PoW, &tmpFrame, MOTO_GAS_RIGHT, MOTO_NO_ROTATION);
-    for(int i=0;i<g_commandsCnt;i++){
-        rotation=MOTO_NO_ROTATION;
-        if(g_commands[i].acceleration!=MOTO_IDLE){
-            if(g_commands[i].time-last_acceleration>g_rotationPeriod){
-                if(accel==MOTO_GAS_RIGHT){
-                    accel=MOTO_GAS_LEFT;
-                }else{
-                    accel=MOTO_GAS_RIGHT;
-                }
-                last_acceleration=g_commands[i].time;
-            }
-        }
-        if(g_commands[i].rotation!=MOTO_NO_ROTATION){
-            if(g_commands[i].time-last_rotation>g_rotationPeriod+1){
-               last_rotation=g_commands[i].time;
-               rotation=g_commands[i].rotation;
-            }
-        }
-
-        tmpFrame.iFrame=g_commands[i].time;
-
-        recordInput(&g_PoW, &tmpFrame, accel, rotation);
-    }
-}
-
-static void regeneratePoW(){
-
-    memcpy (g_commands, g_bestCommands, sizeof (g_bestCommands)) ;
-    for(int i=max(0,randLim(g_commandsCnt+g_commandsCnt/3)-g_commandsCnt/3);i<g_commandsCnt;i++){
-//    for(int i=0;i<g_commandsCnt;i++){
-        g_commands[i].time+=randLim(8*g_temp-7)-4*g_temp;
-        g_commands[i].time=max(0,min(g_commands[i].time,g_totalFrames+1));
-    }
-
-    sort(g_commands,g_commands+g_commandsCnt,less_than_time());
-
-//    Command arr[g_commandsCnt];
-//    std::copy(g_commands.begin(), g_commands.end(), arr);
-
-    updatePow();
-
-}
-
 static CView getBigView()
 {
 	float Size = g_RenderScale*sqrt(g_ViewportSize.area());
@@ -285,7 +191,7 @@ static void draw()
 		int MilliSec = 4*(TimeLeft % 250);
 		char Buffer[16];
 		float LetterSize = 0.03f;
-        sprintf(Buffer, "%02i.%03i:%04i:t%04i:s%02i",Sec, MilliSec,g_i,g_temp,g_success);
+        sprintf(Buffer, "%02i.%03i:%04i:t%04i:s%02i",Sec, MilliSec,g_i,g_Brute.getTemperature(),g_success);
         drawText(Buffer, 1, -30, LetterSize, (TimeLeft == 0) ? 1 : 0);
         sprintf(Buffer, "%i", MOTO_MAX_INPUTS - g_PoW.NumUpdates);
         drawText(Buffer, 2, -30, LetterSize, (MOTO_MAX_INPUTS - g_PoW.NumUpdates == 0) ? 1 : 0);
@@ -382,7 +288,7 @@ static void goToNextWorld()
 	// Find next good world (some worlds are ill-formed).
     DEBUG_MSG("gen 1");
 	do
-        g_PoW.Nonce=rand();
+        g_PoW.Nonce=g_Random.next();
     while (!motoGenerateGoodWorld(&g_World, &g_FirstFrame, g_Work.Block, &g_PoW));
 		
     if(isRender()){prepareWorldRendering(g_World);}
@@ -402,7 +308,12 @@ static void readStdIn()
 		if (cin.fail())
 			return;
 
+		MotoWork Work;
+		bool IsNew = motoParseMessage(Line.c_str(), Work) && Work.IsNew;
+
 		unique_lock<mutex> Lock(g_InputMutex);
+		if (IsNew)
+			g_InputEpoch++;
 		g_InputLines.push_back(move(Line));
 	}
 }
@@ -410,9 +321,9 @@ static void readStdIn()
 static MotoWork getWorkForFun()
 {
     MotoWork Work;
-    srand((unsigned int)system_clock::now().time_since_epoch().count());
+    g_Random.seed((uint64_t)system_clock::now().time_since_epoch().count());
     for (int i = 0; i < MOTO_WORK_SIZE; i++)
-        Work.Block[i] = rand() % 256;
+        Work.Block[i] = g_Random.next() % 256;
     Work.IsNew = false;
     Work.TimeTarget = 250*60;
     //sprintf(Work.Msg, "Block %i, Reward %f MTC, Target %.3f", Work.BlockHeight, 5000000000/100000000.0, Work.TimeTarget/250.0);
@@ -425,12 +336,8 @@ static void startBrute(){
     DEBUG_MSG("go 1");
         goToNextWorld();
         g_State = STATE_BRUTE;
-        g_temp=g_startTemp;
-
-
-
-        regeneratePoW();
-
+        g_Brute.start(g_Work, g_World, g_FirstFrame, g_PoW.Nonce);
+        g_Brute.setEpoch(&g_InputEpoch, g_InputEpoch);
 
         if(isRender()){prepareWorldRendering(g_World);}
         restart();
@@ -593,79 +500,22 @@ static void play()
         g_MotoDir = false;
     }else if (g_State == STATE_BRUTE)
     {
-
-        g_temp--;
-        int k=g_k;
-        if(g_finishDistSq<87412622){
-            k=g_k*2;
-        }
-        if(g_finishDistSq<28088677){
-            k=g_k*4;
-        }
-
-        for(int i=0;i<k;i++){
-		g_Frame = g_FirstFrame;
-            if(g_temp>0&&g_i<10000){
-    //            g_i++;
-                motoReplay(&g_Frame, &g_PoW, &g_World, g_totalFrames);
-                if(g_Frame.curState==MOTO_SUCCESS){
-
-                    g_success++;
-                    g_temp=0;
-                    DEBUG_MSG("success: "<<g_finishDistSq<<"time:"<<g_Frame.iFrame/150);
-                    finalizeBatch();
-//                    for(int i=60;i>0;i--){
-//                        usleep(1000000);
-//                        DEBUG_MSG("sleep: "<<i);
-//                    }
-                    startBrute();
-                    break;
-                }
-
-                if(g_Frame.finishDistSq<g_finishDistSq){
-                    if(g_Frame.finishDistSq<87412622&&g_finishDistSq>87412622){//temporary
-                        g_temp+=g_firstTemp;
-                    }
-                    if(g_Frame.finishDistSq<28088677&&g_finishDistSq>28088677){
-                        g_temp+=g_firstTemp;
-                    }
-                    if(g_Frame.finishDistSq<5088677&&g_finishDistSq>5088677){
-                        g_temp+=g_firstTemp;
-                    }
-
-                    
-//                    if(){}
-                    g_finishDistSq=g_Frame.finishDistSq;
-                    memcpy (g_bestCommands, g_commands, sizeof (g_commands)) ;
-//                    g_State=STATE_REPLAYING;
-//                    g_temp+=g_tempAddition;
-                    
-                    
-                    g_PlayTime=0;
-                }else{
-                    regeneratePoW();
-                    if(i==0&&rand()%100==0){
-                        //cout<<"failure: "<<g_finishDistSq<<"temp:"<<g_temp<<endl;
-                    }
-                }
-
-    //            restart();
-    //            cout << "replay true" << NextFrame<<endl;
+        EBruteResult Result = g_i<10000 ? g_Brute.step() : BRUTE_EXHAUSTED;
+        g_Frame = g_Brute.getFrame();
+        if(Result==BRUTE_SUCCESS){
+            g_success++;
+            g_PoW = g_Brute.getPoW();
+            DEBUG_MSG("success: "<<g_Brute.getBestDistSq()<<"time:"<<g_Frame.iFrame/150);
+            finalizeBatch();
+            startBrute();
+        }else if(Result==BRUTE_EXHAUSTED){
+            if(isRender()){
+                g_PoW = g_Brute.getBestPoW();
+                g_State=STATE_REPLAYING;
+                g_PlayTime=0;
             }else{
-                if(isRender()){
-                    g_temp=0;
-                    memcpy (g_commands, g_bestCommands, sizeof (g_bestCommands)) ;
-                    g_State=STATE_REPLAYING;
-                    g_PlayTime=0;
-                }else{
-//                    cout<<"failure: "<<g_finishDistSq<<"temp:"<<g_temp<<endl;
-                    g_temp=g_startTemp;
-                    g_finishDistSq=((int64_t)1)<<33;
-
-                    DEBUG_MSG("go 4");
-                    goToNextWorld();
-                }
-                break;
+                DEBUG_MSG("go 4");
+                startBrute();
             }
         }
     }
@@ -766,20 +616,6 @@ static void GLFW_ErrorCallback(int iError, const char* pString)
 
 int main(int argc, char** argv)
 {
-    g_PoW.NumFrames=g_totalFrames;
-
-    for(int i=0;i<g_rotateLeftCnt;i++){
-        g_commands[i]=Command(MOTO_ROTATE_CCW);
-    }
-    for(int i=0;i<g_rotateRightCnt;i++){
-        g_commands[i+g_rotateLeftCnt]=(Command(MOTO_ROTATE_CW));
-    }
-    for(int i=0;i<g_switchCnt;i++){
-        g_commands[i+g_rotateLeftCnt+g_rotateRightCnt]=Command(MOTO_GAS_RIGHT);
-    }
-
-    memcpy (g_bestCommands, g_commands, sizeof (g_commands));
-
 
     bool NoFun = false;
     for (int i = 0; i < argc; i++)
@@ -862,7 +698,11 @@ int main(int argc, char** argv)
 //    g_State = STATE_PLAYING;
 
     DEBUG_MSG("go 8");
-    goToNextWorld();
+    // Brute must be restarted too, otherwise it would keep searching world of old work.
+    if (g_State == STATE_BRUTE)
+        startBrute();
+    else
+        goToNextWorld();
     }
 
     if (!(g_PlayingForFun && NoFun))
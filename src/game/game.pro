@@ -19,15 +19,32 @@ SOURCES += \
     sha512.cpp \
     render.cpp \
     graphics.cpp \
+    brute.cpp \
+    search.cpp \
+    input.cpp \
+    anneal.cpp \
+    genetic.cpp \
+    beam.cpp \
+    field.cpp \
     game.cpp \
     ../moto-engine.cpp \
+    ../moto-sha512.cpp \
     ../moto-protocol.cpp
 
 HEADERS += \
     vec2.hpp \
     render.hpp \
     graphics.hpp \
+    brute.hpp \
+    search.hpp \
+    input.hpp \
+    random.hpp \
+    anneal.hpp \
+    genetic.hpp \
+    beam.hpp \
+    field.hpp \
     ../moto-engine.h \
+    ../moto-sha512.h \
     ../moto-protocol.h \
     sha512.h \
     debug.h
@@ -40,7 +57,9 @@ OTHER_FILES += \
     game.creator.user \
     game.creator \
     game.config \
-    build-linux.sh
+    build-linux.sh \
+    build-solver-linux.sh \
+    build-bench-linux.sh
 QMAKE_CXXFLAGS+=-std=c++11
 QMAKE_CXXFLAGS_DEBUG -= -O2
 
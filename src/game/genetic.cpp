@@ -0,0 +1,126 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Genetic (population) search of proof-of-play.
+//--------------------------------------------------------------------
+
+#include <algorithm>
+using namespace std;
+
+#include "genetic.hpp"
+
+// Number of generations, it is increased the same way as temperature of annealing.
+static const int32_t g_StartTemp = 130;
+static const int32_t g_FirstTemp = 45;
+
+static const int64_t g_UnknownDistSq = ((int64_t)1) << 61;
+
+// Updates before Frame are taken from one parent, after it from another. Updates that would make input invalid are dropped.
+static void crossover(const CInput& A, const CInput& B, int16_t Frame, CInput* pChild)
+{
+	pChild->reset(A.getNumFrames());
+	for (int i = 0; i < A.getNumUpdates() && A.getFrame(i) < Frame; i++)
+		pChild->insert(A.getFrame(i), A.getAccel(i), A.getRotation(i));
+	pChild->insert(Frame, B.getAccelBefore(Frame), MOTO_NO_ROTATION);
+	for (int i = 0; i < B.getNumUpdates(); i++)
+		if (B.getFrame(i) >= Frame)
+			pChild->insert(B.getFrame(i), B.getAccel(i), B.getRotation(i));
+}
+
+static bool isCloser(const CGeneticSearch::CIndividual& A, const CGeneticSearch::CIndividual& B)
+{
+	return A.DistSq < B.DistSq;
+}
+
+CGeneticSearch::CGeneticSearch(uint64_t Seed) :
+	CSearchStrategy(Seed)
+{
+	m_Horizon = MaxHorizon;
+	for (int i = 0; i < NumParents + NumChildren; i++)
+	{
+		m_Population[i].Input.reset(m_Horizon);
+		randomize(&m_Population[i].Input);
+		m_Population[i].DistSq = g_UnknownDistSq;
+	}
+	m_NumChildren = 0;
+	m_Suggested = false;
+	m_BestDistSq = g_UnknownDistSq;
+	m_Temp = 0;
+}
+
+void CGeneticSearch::start(const MotoWork& Work, const MotoWorld*, const CDistanceField*, const MotoState&)
+{
+	// Keep parents from previous world, but their distances mean nothing here.
+	m_Horizon = getHorizon(Work);
+	for (int i = 0; i < NumParents + NumChildren; i++)
+	{
+		m_Population[i].Input.setNumFrames(m_Horizon);
+		m_Population[i].DistSq = g_UnknownDistSq;
+	}
+	m_NumChildren = 0;
+	m_Suggested = false;
+	m_BestDistSq = g_UnknownDistSq;
+	m_Temp = g_StartTemp;
+}
+
+void CGeneticSearch::suggest(const MotoPoW& PoW)
+{
+	// Only the most similar solution replaces one of parents, others keep diversity of population.
+	if (m_Suggested)
+		return;
+	m_Population[0].Input.assign(PoW, m_Horizon);
+	m_Suggested = true;
+}
+
+int CGeneticSearch::beginStep()
+{
+	// Select next parents. Sort is stable, so children don't replace parents that are as good as them.
+	stable_sort(m_Population, m_Population + NumParents + m_NumChildren, isCloser);
+	m_NumChildren = 0;
+
+	m_Temp--;
+	if (m_Temp <= 0)
+		return 0;
+	return NumChildren;
+}
+
+// Better parents are selected more often (tournament of two).
+int CGeneticSearch::selectParent()
+{
+	return min(randLim(NumParents), randLim(NumParents));
+}
+
+void CGeneticSearch::propose(MotoPoW* pPoW)
+{
+	const CIndividual& A = m_Population[selectParent()];
+	const CIndividual& B = m_Population[selectParent()];
+	CIndividual& Child = m_Population[NumParents + m_NumChildren];
+
+	crossover(A.Input, B.Input, randLim(m_Horizon), &Child.Input);
+	mutate(&Child.Input, m_Temp);
+	Child.DistSq = g_UnknownDistSq;
+	Child.Input.getPoW(pPoW);
+}
+
+void CGeneticSearch::receive(int64_t DistSq)
+{
+	m_Population[NumParents + m_NumChildren].DistSq = DistSq;
+	m_NumChildren++;
+
+	if (DistSq >= m_BestDistSq)
+		return;
+
+	// More generations each time when we get through one of thresholds.
+	if (DistSq < NearDistSq && m_BestDistSq > NearDistSq)
+		m_Temp += g_FirstTemp;
+	if (DistSq < CloseDistSq && m_BestDistSq > CloseDistSq)
+		m_Temp += g_FirstTemp;
+	if (DistSq < VeryCloseDistSq && m_BestDistSq > VeryCloseDistSq)
+		m_Temp += g_FirstTemp;
+
+	m_BestDistSq = DistSq;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Genetic (population) search of proof-of-play.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_GENETIC_H
+#define MOTOGAME_GENETIC_H
+
+#include "search.hpp"
+
+// Each step is one generation. Children are made by crossover of two parents
+// followed by mutation, best of parents and children become next parents.
+class CGeneticSearch : public CSearchStrategy
+{
+public:
+	static const int NumParents = 8;
+	static const int NumChildren = 16;
+
+	explicit CGeneticSearch(uint64_t Seed);
+
+	const char* getName() const { return "genetic"; }
+	void start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame);
+	void suggest(const MotoPoW& PoW);
+	int beginStep();
+	void propose(MotoPoW* pPoW);
+	void receive(int64_t DistSq);
+	int64_t getBound() const { return m_Population[NumParents - 1].DistSq; }
+	int32_t getTemperature() const { return m_Temp; }
+
+	struct CIndividual
+	{
+		CInput Input;
+		int64_t DistSq;
+	};
+
+private:
+	int16_t m_Horizon;
+
+	// Parents sorted by distance, then children of current generation.
+	CIndividual m_Population[NumParents + NumChildren];
+	int m_NumChildren;
+	bool m_Suggested;
+	int64_t m_BestDistSq;
+	int32_t m_Temp;
+
+	int selectParent();
+};
+
+#endif // MOTOGAME_GENETIC_H
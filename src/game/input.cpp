@@ -0,0 +1,179 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Player input that is edited directly in MotoPoW encoding.
+//--------------------------------------------------------------------
+
+#include <cstdlib>
+#include <algorithm>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "../moto-engine-const.h"
+#include "input.hpp"
+
+static const int g_MaxFrameDelta = 5460; // Longer gaps need updates that don't change anything, they are not used.
+
+CInput::CInput()
+{
+	m_PoW.Nonce = 0;
+	reset(0);
+}
+
+void CInput::reset(int16_t NumFrames)
+{
+	uint32_t Nonce = m_PoW.Nonce;
+	motoInitPoW(&m_PoW);
+	m_PoW.Nonce = Nonce;
+	m_PoW.NumFrames = max<int16_t>(NumFrames, 0);
+}
+
+void CInput::assign(const MotoPoW& PoW, int16_t NumFrames)
+{
+	reset(NumFrames);
+	int Frame = 0;
+	for (int i = 0; i < PoW.NumUpdates && i < MOTO_MAX_INPUTS; i++)
+	{
+		Frame += PoW.Updates[i]/12;
+		if (Frame >= NumFrames)
+			break;
+		insert(Frame, (EMotoAccel)(PoW.Updates[i] % 4), (EMotoRot)((PoW.Updates[i] % 12)/4));
+	}
+}
+
+void CInput::setNumFrames(int16_t NumFrames)
+{
+	m_PoW.NumFrames = max<int16_t>(NumFrames, 0);
+	while (m_PoW.NumUpdates > 0 && m_Frames[m_PoW.NumUpdates - 1] >= m_PoW.NumFrames)
+		m_PoW.NumUpdates--;
+}
+
+void CInput::getPoW(MotoPoW* pPoW) const
+{
+	pPoW->NumFrames = m_PoW.NumFrames;
+	pPoW->NumUpdates = m_PoW.NumUpdates;
+	copy(m_PoW.Updates, m_PoW.Updates + m_PoW.NumUpdates, pPoW->Updates);
+}
+
+EMotoAccel CInput::getAccelBefore(int16_t Frame) const
+{
+	int i = 0;
+	while (i < m_PoW.NumUpdates && m_Frames[i] < Frame)
+		i++;
+	return getPrevAccel(i);
+}
+
+// Check if rotation at Frame is far enough from all rotations except of update Skip.
+bool CInput::canRotate(int16_t Frame, int Skip) const
+{
+	for (int i = 0; i < m_PoW.NumUpdates; i++)
+		if (i != Skip && getRotation(i) != MOTO_NO_ROTATION && abs(m_Frames[i] - Frame) < g_RotationPeriod)
+			return false;
+	return true;
+}
+
+// Store frame difference of update i, its input is kept.
+void CInput::pack(int i)
+{
+	if (i < m_PoW.NumUpdates)
+		m_PoW.Updates[i] = (m_Frames[i] - getPrevFrame(i))*12 + m_PoW.Updates[i] % 12;
+}
+
+void CInput::erase(int i)
+{
+	for (int j = i; j + 1 < m_PoW.NumUpdates; j++)
+	{
+		m_PoW.Updates[j] = m_PoW.Updates[j + 1];
+		m_Frames[j] = m_Frames[j + 1];
+	}
+	m_PoW.NumUpdates--;
+	pack(i);
+}
+
+int32_t CInput::shift(int i, int32_t Shift)
+{
+	int Frame = m_Frames[i];
+	int Min = (i > 0) ? m_Frames[i - 1] + 1 : 0;
+	int Max = m_PoW.NumFrames - 1;
+	if (i + 1 < m_PoW.NumUpdates)
+	{
+		Max = m_Frames[i + 1] - 1;
+		Min = max(Min, m_Frames[i + 1] - g_MaxFrameDelta);
+	}
+	Max = min(Max, getPrevFrame(i) + g_MaxFrameDelta);
+
+	// Rotation can't get closer than rotation period to other ones, it can't be passed either.
+	if (getRotation(i) != MOTO_NO_ROTATION)
+		for (int j = 0; j < m_PoW.NumUpdates; j++)
+			if (j != i && getRotation(j) != MOTO_NO_ROTATION)
+			{
+				if (j < i)
+					Min = max(Min, m_Frames[j] + g_RotationPeriod);
+				else
+					Max = min(Max, m_Frames[j] - g_RotationPeriod);
+			}
+
+	int NewFrame = max(Min, min(Frame + Shift, Max));
+	if (Min > Max)
+		NewFrame = Frame;
+	m_Frames[i] = NewFrame;
+	pack(i);
+	pack(i + 1);
+	return NewFrame - Frame;
+}
+
+bool CInput::insert(int16_t Frame, EMotoAccel Accel, EMotoRot Rotation)
+{
+	if (m_PoW.NumUpdates == MOTO_MAX_INPUTS || Frame < 0 || Frame >= m_PoW.NumFrames)
+		return false;
+
+	int i = 0;
+	while (i < m_PoW.NumUpdates && m_Frames[i] < Frame)
+		i++;
+	if (i < m_PoW.NumUpdates && m_Frames[i] == Frame)
+		return false;
+	if (Accel == getPrevAccel(i) && Rotation == MOTO_NO_ROTATION)
+		return false;
+	if (Rotation != MOTO_NO_ROTATION && !canRotate(Frame, -1))
+		return false;
+	if (Frame - getPrevFrame(i) > g_MaxFrameDelta)
+		return false;
+
+	// Next update that would change nothing is removed, but gap after it must not get too long.
+	bool RemoveNext = i < m_PoW.NumUpdates && getRotation(i) == MOTO_NO_ROTATION && getAccel(i) == Accel;
+	if (RemoveNext && i + 1 < m_PoW.NumUpdates && m_Frames[i + 1] - Frame > g_MaxFrameDelta)
+		return false;
+
+	for (int j = m_PoW.NumUpdates; j > i; j--)
+	{
+		m_PoW.Updates[j] = m_PoW.Updates[j - 1];
+		m_Frames[j] = m_Frames[j - 1];
+	}
+	m_PoW.NumUpdates++;
+	m_Frames[i] = Frame;
+	m_PoW.Updates[i] = (uint16_t)(Rotation*4 + Accel);
+	pack(i);
+	pack(i + 1);
+	if (RemoveNext)
+		erase(i + 1);
+	return true;
+}
+
+bool CInput::remove(int i)
+{
+	// Next update doesn't change anything if it has the same acceleration as previous one.
+	int Last = i;
+	if (i + 1 < m_PoW.NumUpdates && getRotation(i + 1) == MOTO_NO_ROTATION && getAccel(i + 1) == getPrevAccel(i))
+		Last = i + 1;
+	if (Last + 1 < m_PoW.NumUpdates && m_Frames[Last + 1] - getPrevFrame(i) > g_MaxFrameDelta)
+		return false;
+
+	if (Last != i)
+		erase(i + 1);
+	erase(i);
+	return true;
+}
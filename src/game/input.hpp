@@ -0,0 +1,68 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Player input that is edited directly in MotoPoW encoding and stays
+// valid after each edit, so search never simulates invalid proofs.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_INPUT_H
+#define MOTOGAME_INPUT_H
+
+#include "../moto-engine.h"
+
+// Input that motoIsValidInput() accepts. Edits that would make it invalid are clamped or refused.
+class CInput
+{
+public:
+	CInput();
+
+	// No updates, input may reach frame NumFrames.
+	void reset(int16_t NumFrames);
+
+	// Valid part of other input (e.g. solution of another world) with different NumFrames.
+	// Updates that can't be kept are dropped.
+	void assign(const MotoPoW& PoW, int16_t NumFrames);
+
+	// Updates after NumFrames are dropped.
+	void setNumFrames(int16_t NumFrames);
+
+	// Copy input to PoW, nonce is not changed.
+	void getPoW(MotoPoW* pPoW) const;
+
+	int16_t getNumFrames() const { return m_PoW.NumFrames; }
+	int getNumUpdates() const { return m_PoW.NumUpdates; }
+	int16_t getFrame(int i) const { return m_Frames[i]; }
+	EMotoAccel getAccel(int i) const { return (EMotoAccel)(m_PoW.Updates[i] % 4); }
+	EMotoRot getRotation(int i) const { return (EMotoRot)((m_PoW.Updates[i] % 12)/4); }
+
+	// Acceleration just before Frame.
+	EMotoAccel getAccelBefore(int16_t Frame) const;
+
+	// Move update i by Shift frames. Shift is clamped so that update stays between its neighbors
+	// and its rotation stays far enough from others. Returns shift that was done.
+	int32_t shift(int i, int32_t Shift);
+
+	// Add update, returns false if it can't be done without making input invalid.
+	// Next update is removed if it doesn't change anything after that.
+	bool insert(int16_t Frame, EMotoAccel Accel, EMotoRot Rotation);
+
+	// Remove update, returns false if gap between its neighbors would be too long.
+	// Next update is removed too if it doesn't change anything after that.
+	bool remove(int i);
+
+private:
+	MotoPoW m_PoW;
+	int16_t m_Frames[MOTO_MAX_INPUTS]; // Frame of each update, Updates store only differences.
+
+	int16_t getPrevFrame(int i) const { return i > 0 ? m_Frames[i - 1] : 0; }
+	EMotoAccel getPrevAccel(int i) const { return i > 0 ? getAccel(i - 1) : MOTO_IDLE; }
+	bool canRotate(int16_t Frame, int Skip) const;
+	void pack(int i);
+	void erase(int i);
+};
+
+#endif // MOTOGAME_INPUT_H
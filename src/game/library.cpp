@@ -0,0 +1,165 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Library of solutions found before.
+//--------------------------------------------------------------------
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "library.hpp"
+
+static const int g_PathPoints[CWorldFeatures::NumPoints] = { 8, 16, 32, 64 };
+
+// Offset between cells of distance field, it wraps around.
+static int32_t getOffset(int From, int To)
+{
+	return ((To - From + CDistanceField::Size/2) & (CDistanceField::Size - 1)) - CDistanceField::Size/2;
+}
+
+static int64_t getDifference(const CWorldFeatures& A, const CWorldFeatures& B)
+{
+	int64_t Diff = (int64_t)(A.Length - B.Length)*(A.Length - B.Length);
+	for (int i = 0; i < CWorldFeatures::NumPoints; i++)
+		for (int k = 0; k < 2; k++)
+			Diff += (int64_t)(A.Path[i][k] - B.Path[i][k])*(A.Path[i][k] - B.Path[i][k]);
+	return Diff;
+}
+
+// One solution per line: features, NumFrames, NumUpdates and updates.
+static string format(const CWorldFeatures& Features, const MotoPoW& PoW)
+{
+	ostringstream Stream;
+	Stream << Features.Length;
+	for (int i = 0; i < CWorldFeatures::NumPoints; i++)
+		Stream << ' ' << Features.Path[i][0] << ' ' << Features.Path[i][1];
+	Stream << ' ' << PoW.NumFrames << ' ' << PoW.NumUpdates;
+	for (int i = 0; i < PoW.NumUpdates; i++)
+		Stream << ' ' << PoW.Updates[i];
+	Stream << '\n';
+	return Stream.str();
+}
+
+static bool parse(const string& Line, CWorldFeatures* pFeatures, MotoPoW* pPoW)
+{
+	istringstream Stream(Line);
+	Stream >> pFeatures->Length;
+	for (int i = 0; i < CWorldFeatures::NumPoints; i++)
+		Stream >> pFeatures->Path[i][0] >> pFeatures->Path[i][1];
+
+	motoInitPoW(pPoW);
+	Stream >> pPoW->NumFrames >> pPoW->NumUpdates;
+	if (!Stream || pPoW->NumUpdates > MOTO_MAX_INPUTS)
+		return false;
+	for (int i = 0; i < pPoW->NumUpdates; i++)
+		Stream >> pPoW->Updates[i];
+	return !Stream.fail();
+}
+
+void CSolutionLibrary::getFeatures(const CDistanceField& Field, const MotoState& FirstFrame, CWorldFeatures* pFeatures)
+{
+	vector<pair<int, int> > Path;
+	Field.getPath(FirstFrame.Bike.Pos, CDistanceField::Size, &Path);
+	memset(pFeatures, 0, sizeof(*pFeatures));
+	pFeatures->Length = (int32_t)Path.size();
+	if (Path.empty())
+		return;
+
+	// Short path ends at finish.
+	for (int i = 0; i < CWorldFeatures::NumPoints; i++)
+	{
+		const pair<int, int>& Cell = Path[min<size_t>(g_PathPoints[i], Path.size() - 1)];
+		pFeatures->Path[i][0] = getOffset(Path[0].first, Cell.first);
+		pFeatures->Path[i][1] = getOffset(Path[0].second, Cell.second);
+	}
+}
+
+int CSolutionLibrary::open(const string& Path)
+{
+	unique_lock<mutex> Lock(m_Mutex);
+	m_Path = Path;
+	m_Entries.clear();
+
+	ifstream File(Path.c_str());
+	if (!File.is_open())
+		return 0;
+
+	int NumLines = 0;
+	int NumSkipped = 0;
+	string Line;
+	while (getline(File, Line))
+	{
+		CEntry Entry;
+		if (Line.empty())
+			continue;
+		if (!parse(Line, &Entry.Features, &Entry.PoW))
+		{
+			NumSkipped++;
+			continue;
+		}
+		push(Entry);
+		NumLines++;
+	}
+
+	// Don't let the file grow forever, rewrite it with solutions that are remembered.
+	// Bad lines are dropped the same way.
+	if (NumLines > 2*MaxSolutions || NumSkipped > 0)
+	{
+		File.close();
+		ofstream Out(Path.c_str(), ios::trunc);
+		for (const CEntry& Entry : m_Entries)
+			Out << format(Entry.Features, Entry.PoW);
+	}
+	return NumSkipped;
+}
+
+void CSolutionLibrary::push(const CEntry& Entry)
+{
+	if ((int)m_Entries.size() >= MaxSolutions)
+		m_Entries.erase(m_Entries.begin());
+	m_Entries.push_back(Entry);
+}
+
+void CSolutionLibrary::add(const CWorldFeatures& Features, const MotoPoW& PoW)
+{
+	CEntry Entry;
+	Entry.Features = Features;
+	Entry.PoW = PoW;
+
+	unique_lock<mutex> Lock(m_Mutex);
+	push(Entry);
+	if (m_Path.empty())
+		return;
+	ofstream File(m_Path.c_str(), ios::app);
+	File << format(Features, PoW);
+}
+
+void CSolutionLibrary::findNearest(const CWorldFeatures& Features, int MaxResults, vector<MotoPoW>* pSolutions) const
+{
+	unique_lock<mutex> Lock(m_Mutex);
+
+	// Recent solutions go first, so they win among equally similar ones.
+	vector<pair<int64_t, int> > Order;
+	for (int i = (int)m_Entries.size() - 1; i >= 0; i--)
+		Order.push_back(make_pair(getDifference(Features, m_Entries[i].Features), (int)m_Entries.size() - 1 - i));
+	int NumResults = min(MaxResults, (int)Order.size());
+	partial_sort(Order.begin(), Order.begin() + NumResults, Order.end());
+
+	pSolutions->clear();
+	for (int i = 0; i < NumResults; i++)
+		pSolutions->push_back(m_Entries[m_Entries.size() - 1 - Order[i].second].PoW);
+}
+
+int CSolutionLibrary::getNumSolutions() const
+{
+	unique_lock<mutex> Lock(m_Mutex);
+	return (int)m_Entries.size();
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Library of solutions found before. New world starts search from
+// solutions of the most similar worlds instead of random input.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_LIBRARY_H
+#define MOTOGAME_LIBRARY_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../moto-engine.h"
+#include "field.hpp"
+
+// Start and finish are the same in all worlds, so worlds are compared by shape of the path through the sky.
+struct CWorldFeatures
+{
+	static const int NumPoints = 4;
+
+	int32_t Path[NumPoints][2]; // Cell offsets from start to path cells 8, 16, 32 and 64.
+	int32_t Length;             // Number of cells in path (up to 256), 0 if start is cut off from finish.
+};
+
+// Shared by all workers, so all methods are thread-safe.
+class CSolutionLibrary
+{
+public:
+	static const int MaxSolutions = 4096; // Older solutions are forgotten.
+
+	static void getFeatures(const CDistanceField& Field, const MotoState& FirstFrame, CWorldFeatures* pFeatures);
+
+	// Load solutions saved before, they are appended to the same file.
+	// Missing file is created when first solution is added. Lines that can't be parsed
+	// (e.g. torn by crash while appending) are skipped, returns their number.
+	int open(const std::string& Path);
+
+	void add(const CWorldFeatures& Features, const MotoPoW& PoW);
+
+	// Up to MaxResults solutions of the most similar worlds, the most similar first.
+	void findNearest(const CWorldFeatures& Features, int MaxResults, std::vector<MotoPoW>* pSolutions) const;
+
+	int getNumSolutions() const;
+
+private:
+	struct CEntry
+	{
+		CWorldFeatures Features;
+		MotoPoW PoW;
+	};
+
+	mutable std::mutex m_Mutex;
+	std::vector<CEntry> m_Entries;
+	std::string m_Path;
+
+	void push(const CEntry& Entry);
+};
+
+#endif // MOTOGAME_LIBRARY_H
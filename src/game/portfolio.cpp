@@ -0,0 +1,237 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Search in several worlds at once.
+//--------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+using namespace std;
+using namespace chrono;
+
+#include "../moto-engine.h"
+#include "portfolio.hpp"
+
+// Scheduling parameters.
+static const double g_StartRate = 1.0;      // Rate of new world, it is optimistic so new worlds are tried soon.
+static const double g_MinRate = 0.05;       // Even worlds that don't improve get some time until they stagnate.
+static const double g_RateWindow = 1000;    // Number of candidates over which rate is averaged.
+static const uint64_t g_StagnationCandidates = 3000; // World is abandoned if its best distance doesn't improve for that long.
+static const int g_NumSuggestions = 1;      // Solutions of similar worlds given to strategy of new world.
+
+static const int64_t g_UnknownDistSq = ((int64_t)1) << 61;
+
+CPortfolio::CPortfolio(const string& Strategy, uint64_t Seed, int NumWorlds, CSolutionLibrary* pLibrary, CTelemetryLog* pTelemetry) :
+	m_Strategy(Strategy),
+	m_pLibrary(pLibrary),
+	m_pTelemetry(pTelemetry),
+	m_Slots(max(NumWorlds, 1)),
+	m_Random(Seed),
+	m_pEpoch(NULL),
+	m_Epoch(0)
+{
+	motoInitPoW(&m_PoW);
+	memset(&m_World, 0, sizeof(m_World));
+	memset(&m_FirstFrame, 0, sizeof(m_FirstFrame));
+	memset(&m_LastEnded, 0, sizeof(m_LastEnded));
+	memset(m_NumEnded, 0, sizeof(m_NumEnded));
+	for (CSlot& Slot : m_Slots)
+	{
+		memset(&Slot.Stats, 0, sizeof(Slot.Stats));
+		memset(&Slot.Features, 0, sizeof(Slot.Features));
+		Slot.LastImprovement = 0;
+		Slot.Pass = 0;
+	}
+}
+
+void CPortfolio::setWork(const shared_ptr<const MotoWork>& pWork)
+{
+	m_pWork = pWork;
+}
+
+void CPortfolio::clear()
+{
+	for (CSlot& Slot : m_Slots)
+		if (Slot.pWork)
+			endWorld(Slot, WORLD_DROPPED);
+	m_pSolvedWork.reset();
+}
+
+void CPortfolio::setEpoch(const atomic<unsigned int>* pEpoch, unsigned int Epoch)
+{
+	m_pEpoch = pEpoch;
+	m_Epoch = Epoch;
+	for (CSlot& Slot : m_Slots)
+		if (Slot.pBrute)
+			Slot.pBrute->setEpoch(pEpoch, Epoch);
+}
+
+// Generate new world for the slot (some worlds are ill-formed).
+void CPortfolio::startWorld(CSlot& Slot)
+{
+	if (!Slot.pBrute)
+	{
+		Slot.pBrute.reset(new CBruteForce(createSearchStrategy(m_Strategy, m_Random.next64())));
+		Slot.pBrute->setEpoch(m_pEpoch, m_Epoch);
+	}
+
+	MotoPoW PoW;
+	motoInitPoW(&PoW);
+	uint32_t NumNonces = 0;
+	while (true)
+	{
+		uint32_t FirstNonce = m_Random.next();
+		PoW.Nonce = FirstNonce;
+		bool Good = motoGenerateGoodWorld(&m_World, &m_FirstFrame, m_pWork->Block, &PoW);
+		NumNonces += PoW.Nonce - FirstNonce;
+		if (Good)
+			break;
+	}
+
+	Slot.pWork = m_pWork;
+	Slot.pBrute->start(*m_pWork, m_World, m_FirstFrame, PoW.Nonce);
+	if (m_pLibrary)
+	{
+		CSolutionLibrary::getFeatures(Slot.pBrute->getField(), m_FirstFrame, &Slot.Features);
+		vector<MotoPoW> Solutions;
+		m_pLibrary->findNearest(Slot.Features, g_NumSuggestions, &Solutions);
+		for (const MotoPoW& Solution : Solutions)
+			Slot.pBrute->suggest(Solution);
+	}
+	memset(&Slot.Stats, 0, sizeof(Slot.Stats));
+	Slot.Stats.Nonce = PoW.Nonce;
+	Slot.Stats.NumNonces = NumNonces;
+	Slot.Stats.StartDistSq = Slot.pBrute->getField().getDistSq(m_FirstFrame.Bike.Pos, m_FirstFrame.finishDistSq);
+	Slot.Stats.BestDistSq = g_UnknownDistSq;
+	Slot.Stats.Rate = g_StartRate;
+	Slot.Stats.End = WORLD_ACTIVE;
+	Slot.LastImprovement = 0;
+	Slot.Progress.clear();
+
+	// Don't let new world catch up with time that others already got.
+	Slot.Pass = 0;
+	bool First = true;
+	for (const CSlot& Other : m_Slots)
+		if (&Other != &Slot && Other.pWork && (First || Other.Pass < Slot.Pass))
+		{
+			Slot.Pass = Other.Pass;
+			First = false;
+		}
+}
+
+void CPortfolio::endWorld(CSlot& Slot, EWorldEnd End)
+{
+	Slot.Stats.End = End;
+	m_LastEnded = Slot.Stats;
+	m_NumEnded[End]++;
+	if (m_pTelemetry)
+		record(Slot);
+	Slot.pWork.reset();
+}
+
+void CPortfolio::record(CSlot& Slot)
+{
+	const CWorldStats& Stats = Slot.Stats;
+	CTelemetryWorld World;
+	World.Nonce = Stats.Nonce;
+	World.NumNonces = Stats.NumNonces;
+	World.StartDistSq = Stats.StartDistSq;
+	World.TimeTarget = Slot.pWork->TimeTarget;
+	World.End = (uint8_t)Stats.End;
+	World.Strategy = Slot.pBrute->getStrategyName();
+	World.NumCandidates = Stats.NumCandidates;
+	World.NumFrames = Stats.NumFrames;
+	World.BestDistSq = (Stats.End == WORLD_SOLVED) ? 0 : Stats.BestDistSq;
+	World.Temperature = Slot.pBrute->getTemperature();
+	World.Milliseconds = (uint32_t)(Stats.Seconds*1000);
+	World.Progress.swap(Slot.Progress);
+	m_pTelemetry->write(World);
+}
+
+EBruteResult CPortfolio::step()
+{
+	if (!m_pWork)
+		return BRUTE_CONTINUE;
+
+	// Stride scheduling: each world gets time proportional to its rate of progress.
+	CSlot* pSlot = NULL;
+	for (CSlot& Slot : m_Slots)
+	{
+		// Starting a world takes much longer than one candidate, don't start worlds of stale work.
+		if (!Slot.pWork)
+		{
+			if (m_pEpoch && m_pEpoch->load(memory_order_relaxed) != m_Epoch)
+				return BRUTE_CONTINUE;
+			startWorld(Slot);
+		}
+		if (!pSlot || Slot.Pass < pSlot->Pass)
+			pSlot = &Slot;
+	}
+	CSlot& Slot = *pSlot;
+	CWorldStats& Stats = Slot.Stats;
+
+	uint64_t NumCandidates = Slot.pBrute->getNumCandidates();
+	uint64_t NumFrames = Slot.pBrute->getNumFrames();
+	steady_clock::time_point Start = steady_clock::now();
+	EBruteResult Result = Slot.pBrute->step();
+	Stats.Seconds += duration<double>(steady_clock::now() - Start).count();
+	uint64_t Used = max<uint64_t>(Slot.pBrute->getNumCandidates() - NumCandidates, 1);
+	Stats.NumCandidates += Used;
+	Stats.NumFrames += Slot.pBrute->getNumFrames() - NumFrames;
+	Stats.NumSlices++;
+
+	if (Result == BRUTE_SUCCESS)
+	{
+		m_PoW = Slot.pBrute->getPoW();
+		m_pSolvedWork = Slot.pWork;
+		if (m_pLibrary)
+			m_pLibrary->add(Slot.Features, m_PoW);
+		endWorld(Slot, WORLD_SOLVED);
+		return BRUTE_SUCCESS;
+	}
+	if (Result == BRUTE_EXHAUSTED)
+	{
+		endWorld(Slot, WORLD_EXHAUSTED);
+		return BRUTE_EXHAUSTED;
+	}
+
+	int64_t BestDistSq = Slot.pBrute->getBestDistSq();
+	double Gain = 0;
+	if (BestDistSq < Stats.BestDistSq)
+	{
+		if (Stats.BestDistSq != g_UnknownDistSq)
+			Gain = log((double)Stats.BestDistSq/max<int64_t>(BestDistSq, 1));
+		Stats.BestDistSq = BestDistSq;
+		Slot.LastImprovement = Stats.NumCandidates;
+		if (m_pTelemetry)
+		{
+			CTelemetryPoint Point;
+			Point.NumCandidates = Stats.NumCandidates;
+			Point.NumFrames = Stats.NumFrames;
+			Point.BestDistSq = BestDistSq;
+			Point.Temperature = Slot.pBrute->getTemperature();
+			Point.Milliseconds = (uint32_t)(Stats.Seconds*1000);
+			Slot.Progress.push_back(Point);
+		}
+	}
+	if (Stats.NumSlices > 1)
+	{
+		double Alpha = min(1.0, Used/g_RateWindow);
+		Stats.Rate = (1 - Alpha)*Stats.Rate + Alpha*Gain*1000/Used;
+	}
+	Slot.Pass += Used/(Stats.Rate + g_MinRate);
+
+	if (Stats.NumCandidates - Slot.LastImprovement > g_StagnationCandidates)
+	{
+		endWorld(Slot, WORLD_STAGNATED);
+		return BRUTE_EXHAUSTED;
+	}
+	return BRUTE_CONTINUE;
+}
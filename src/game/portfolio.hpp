@@ -0,0 +1,119 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Search in several worlds at once. Worlds that improve faster get
+// more time, worlds that stagnate are replaced by new ones.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_PORTFOLIO_H
+#define MOTOGAME_PORTFOLIO_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../moto-engine.h"
+#include "brute.hpp"
+#include "library.hpp"
+#include "random.hpp"
+#include "telemetry.hpp"
+
+// Why world left the portfolio.
+enum EWorldEnd
+{
+	WORLD_ACTIVE,
+	WORLD_SOLVED,
+	WORLD_EXHAUSTED,  // Strategy gave up.
+	WORLD_STAGNATED,  // Best distance didn't improve for too long.
+	WORLD_DROPPED,    // Work was replaced.
+};
+
+struct CWorldStats
+{
+	uint32_t Nonce;
+	uint32_t NumNonces;     // Scanned to find this world.
+	uint64_t NumCandidates; // Evaluated in this world.
+	uint64_t NumFrames;     // Simulated in this world.
+	uint64_t NumSlices;
+	double Seconds;         // Spent in this world.
+	int64_t StartDistSq;
+	int64_t BestDistSq;
+	double Rate;            // Recent progress, log of improvement of best distance per 1000 candidates.
+	EWorldEnd End;
+};
+
+class CPortfolio
+{
+public:
+	static const int DefaultNumWorlds = 8;
+
+	// Seed chooses worlds and seeds their strategies, so the same seed and work give the same search.
+	// Solutions are added to library and new worlds start from solutions of similar worlds if it is not NULL.
+	// Search in each world is recorded to telemetry log when world ends if it is not NULL.
+	CPortfolio(const std::string& Strategy, uint64_t Seed, int NumWorlds = DefaultNumWorlds, CSolutionLibrary* pLibrary = NULL,
+		CTelemetryLog* pTelemetry = NULL);
+
+	// Work for worlds that are generated from now on, worlds of previous work are kept.
+	void setWork(const std::shared_ptr<const MotoWork>& pWork);
+
+	// Drop all worlds, e.g. when previous work became useless.
+	void clear();
+
+	// Step stops early when *pEpoch differs from Epoch, see CBruteForce::setEpoch().
+	void setEpoch(const std::atomic<unsigned int>* pEpoch, unsigned int Epoch);
+
+	// Give one step of search to one of worlds.
+	// BRUTE_SUCCESS - solution is available with getPoW() and getWork(),
+	// BRUTE_EXHAUSTED - world is abandoned, see getLastEnded().
+	EBruteResult step();
+
+	const MotoPoW& getPoW() const { return m_PoW; }
+	const std::shared_ptr<const MotoWork>& getWork() const { return m_pSolvedWork; }
+
+	int getNumWorlds() const { return (int)m_Slots.size(); }
+	const CWorldStats& getStats(int i) const { return m_Slots[i].Stats; }
+
+	// Stats of world that was solved or abandoned last.
+	const CWorldStats& getLastEnded() const { return m_LastEnded; }
+
+	// Number of worlds that ended in each way since construction.
+	uint64_t getNumEnded(EWorldEnd End) const { return m_NumEnded[End]; }
+
+private:
+	struct CSlot
+	{
+		std::unique_ptr<CBruteForce> pBrute;
+		std::shared_ptr<const MotoWork> pWork;
+		CWorldStats Stats;
+		CWorldFeatures Features;
+		uint64_t LastImprovement; // Candidates evaluated before last improvement.
+		double Pass;              // Candidates weighted by share of time, slot with least pass runs next.
+		std::vector<CTelemetryPoint> Progress; // Recorded only if there is telemetry log.
+	};
+
+	std::string m_Strategy;
+	CSolutionLibrary* m_pLibrary;
+	CTelemetryLog* m_pTelemetry;
+	std::vector<CSlot> m_Slots;
+	std::shared_ptr<const MotoWork> m_pWork;
+	std::shared_ptr<const MotoWork> m_pSolvedWork;
+	MotoPoW m_PoW;
+	MotoWorld m_World;
+	MotoState m_FirstFrame;
+	CWorldStats m_LastEnded;
+	uint64_t m_NumEnded[WORLD_DROPPED + 1];
+	CRandom m_Random;
+	const std::atomic<unsigned int>* m_pEpoch;
+	unsigned int m_Epoch;
+
+	void startWorld(CSlot& Slot);
+	void endWorld(CSlot& Slot, EWorldEnd End);
+	void record(CSlot& Slot);
+};
+
+#endif // MOTOGAME_PORTFOLIO_H
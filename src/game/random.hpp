@@ -0,0 +1,50 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Small seedable random generator. Each search worker owns one, so
+// workers don't share state of rand() and runs can be reproduced.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_RANDOM_H
+#define MOTOGAME_RANDOM_H
+
+#include <stdint.h>
+
+// Xorshift64* seeded by splitmix64, so that close seeds (e.g. seed + worker number) give unrelated sequences.
+class CRandom
+{
+public:
+	explicit CRandom(uint64_t Seed = 0) { seed(Seed); }
+
+	void seed(uint64_t Seed)
+	{
+		uint64_t z = Seed + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27))*0x94D049BB133111EBull;
+		m_State = z ^ (z >> 31);
+		if (m_State == 0)
+			m_State = 1;
+	}
+
+	uint32_t next()
+	{
+		m_State ^= m_State >> 12;
+		m_State ^= m_State << 25;
+		m_State ^= m_State >> 27;
+		return (uint32_t)((m_State*0x2545F4914F6CDD1Dull) >> 32);
+	}
+
+	uint64_t next64() { return ((uint64_t)next() << 32) | next(); }
+
+	// Uniform in [0, Lim), 0 if Lim <= 0.
+	int lim(int Lim) { return Lim > 0 ? (int)(((uint64_t)next()*(uint32_t)Lim) >> 32) : 0; }
+
+private:
+	uint64_t m_State;
+};
+
+#endif // MOTOGAME_RANDOM_H
@@ -0,0 +1,88 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Input helpers shared by search strategies.
+//--------------------------------------------------------------------
+
+#include <algorithm>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "search.hpp"
+#include "anneal.hpp"
+#include "genetic.hpp"
+#include "beam.hpp"
+
+static const int16_t g_FirstGasFrame = 1.5*250;
+static const int g_MutateKinds = 8; // Insertion of rotation, insertion of switch, removal or none of them.
+
+int16_t CSearchStrategy::getHorizon(const MotoWork& Work)
+{
+	return max(1, min<int>(Work.TimeTarget - 1, MaxHorizon));
+}
+
+static EMotoAccel getOtherAccel(EMotoAccel Accel)
+{
+	return (Accel == MOTO_GAS_RIGHT) ? MOTO_GAS_LEFT : MOTO_GAS_RIGHT;
+}
+
+// Rotation or switch of acceleration at random time, it is refused if input would become invalid.
+static bool insertEvent(CInput* pInput, int16_t Frame, bool Switch, EMotoRot Rotation)
+{
+	EMotoAccel Accel = pInput->getAccelBefore(Frame);
+	if (Switch)
+		return pInput->insert(Frame, getOtherAccel(Accel), MOTO_NO_ROTATION);
+	return pInput->insert(Frame, Accel, Rotation);
+}
+
+void CSearchStrategy::randomize(CInput* pInput)
+{
+	pInput->reset(pInput->getNumFrames());
+
+	// Always start with gas.
+	pInput->insert(g_FirstGasFrame, MOTO_GAS_RIGHT, MOTO_NO_ROTATION);
+	for (int i = 0; i < NumCommands; i++)
+	{
+		int16_t Frame = g_FirstGasFrame + 1 + randLim(MaxHorizon - g_FirstGasFrame - 1);
+		if (i < NumRotateLeft)
+			insertEvent(pInput, Frame, false, MOTO_ROTATE_CCW);
+		else if (i < NumRotateLeft + NumRotateRight)
+			insertEvent(pInput, Frame, false, MOTO_ROTATE_CW);
+		else
+			insertEvent(pInput, Frame, true, MOTO_NO_ROTATION);
+	}
+}
+
+void CSearchStrategy::mutate(CInput* pInput, int32_t Temp)
+{
+	// Sometimes change number of events, the first gas is kept.
+	int Kind = randLim(g_MutateKinds);
+	int16_t Frame = g_FirstGasFrame + 1 + randLim(MaxHorizon - g_FirstGasFrame - 1);
+	if (Kind == 0)
+		insertEvent(pInput, Frame, false, randLim(2) ? MOTO_ROTATE_CW : MOTO_ROTATE_CCW);
+	else if (Kind == 1)
+		insertEvent(pInput, Frame, true, MOTO_NO_ROTATION);
+	else if (Kind == 2 && pInput->getNumUpdates() > 1)
+		pInput->remove(1 + randLim(pInput->getNumUpdates() - 1));
+
+	// Earlier updates are kept more often, so candidate shares checkpoints with its origin.
+	int NumUpdates = pInput->getNumUpdates();
+	int First = max(1, randLim(NumUpdates + NumUpdates/3) - NumUpdates/3);
+	for (int i = NumUpdates - 1; i >= First; i--)
+		pInput->shift(i, randLim(8*Temp - 7) - 4*Temp);
+}
+
+CSearchStrategy* createSearchStrategy(const string& Name, uint64_t Seed)
+{
+	if (Name == "annealing")
+		return new CAnnealing(Seed);
+	if (Name == "genetic")
+		return new CGeneticSearch(Seed);
+	if (Name == "beam")
+		return new CBeamSearch;
+	return NULL;
+}
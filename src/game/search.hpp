@@ -0,0 +1,105 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Interface of proof-of-play search strategies. Strategy proposes
+// candidates and receives their fitness, CBruteForce replays them.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_SEARCH_H
+#define MOTOGAME_SEARCH_H
+
+#include <string>
+
+#include "../moto-engine.h"
+#include "field.hpp"
+#include "input.hpp"
+#include "random.hpp"
+
+// Result of one search step.
+enum EBruteResult
+{
+	BRUTE_CONTINUE,  // Nothing is found yet, call step() again.
+	BRUTE_SUCCESS,   // Solution is found, it is available with getPoW().
+	BRUTE_EXHAUSTED, // Temperature is over, world should be abandoned.
+};
+
+class CSearchStrategy
+{
+public:
+	static const int NumRotateRight = 15;
+	static const int NumRotateLeft = 15;
+	static const int NumSwitch = 5;
+	static const int NumCommands = NumRotateRight + NumRotateLeft + NumSwitch;
+
+	// Events of random input are placed within this number of frames. Longer games are allowed
+	// by most time targets, but short solutions are found faster.
+	static const int16_t MaxHorizon = 30*250;
+
+	// Squared distance thresholds to finish.
+	static const int64_t NearDistSq = 87412622;
+	static const int64_t CloseDistSq = 28088677;
+	static const int64_t VeryCloseDistSq = 5088677;
+
+	virtual ~CSearchStrategy() {}
+
+	virtual const char* getName() const = 0;
+
+	// Start search in new world, world and its distance field stay valid until next start.
+	// Strategy may use what it found in previous world as starting point.
+	virtual void start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame) = 0;
+
+	// Solution of similar world (see CSolutionLibrary) that search may start from instead of random input.
+	// Called after start() for each of suggested solutions, the most similar first.
+	virtual void suggest(const MotoPoW& /*PoW*/) {}
+
+	// Strategies that resume their own states instead of proposing candidates for replay do whole step here.
+	// pPoW (out) - solution or closest candidate of the step (without nonce), pFrame (out) - its last frame,
+	// pNumFrames (out) - number of frames simulated in the step.
+	// Returns false if strategy proposes candidates, then methods below are used instead.
+	virtual bool simulateStep(EBruteResult* /*pResult*/, MotoPoW* /*pPoW*/, MotoState* /*pFrame*/, int* /*pNumCandidates*/, int* /*pNumFrames*/) { return false; }
+
+	// Begin next step, returns number of candidates to evaluate in it or 0 if world should be abandoned.
+	virtual int beginStep() { return 0; }
+
+	// Next candidate to evaluate (without nonce).
+	virtual void propose(MotoPoW* /*pPoW*/) {}
+
+	// Squared distance to finish through the sky (see CDistanceField) that was reached by last proposed candidate.
+	// It is exact only if it is less than getBound(), otherwise candidate could be stopped earlier.
+	virtual void receive(int64_t /*DistSq*/) {}
+
+	// Candidates that don't get closer to finish than this are of no interest.
+	virtual int64_t getBound() const { return 0; }
+
+	// Remaining effort in current world, search is exhausted when it reaches 0.
+	virtual int32_t getTemperature() const = 0;
+
+	// Last frame that candidate may reach, solution must be completed in less than TimeTarget frames.
+	static int16_t getHorizon(const MotoWork& Work);
+
+protected:
+	// Strategies that use random numbers take seed, the same seed and world give the same search.
+	explicit CSearchStrategy(uint64_t Seed = 0) : m_Random(Seed) {}
+
+	int randLim(int Lim) { return m_Random.lim(Lim); }
+
+	// Random input: gas and then NumCommands rotations and switches of acceleration,
+	// times are uniformly distributed. Events that would make input invalid are skipped.
+	void randomize(CInput* pInput);
+
+	// Sometimes insert or remove an event, then randomly shift some of last updates.
+	// Shift amplitude is proportional to temperature. Input stays valid.
+	void mutate(CInput* pInput, int32_t Temp);
+
+private:
+	CRandom m_Random;
+};
+
+// Strategy by name ("annealing", "genetic" or "beam"), NULL if there is no such strategy.
+CSearchStrategy* createSearchStrategy(const std::string& Name, uint64_t Seed);
+
+#endif // MOTOGAME_SEARCH_H
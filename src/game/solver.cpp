@@ -0,0 +1,518 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Headless solver. Speaks the same stdio protocol as motogame but
+// doesn't render anything and runs one search worker per core.
+// With -connect it gets work from work server of motocoind instead.
+//--------------------------------------------------------------------
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #define SHUT_RDWR SD_BOTH
+#else
+    #include <unistd.h>
+    #include <signal.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    typedef int SOCKET;
+    #define INVALID_SOCKET (-1)
+    #define closesocket close
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+#include "../moto-engine.h"
+#include "../moto-protocol.h"
+#include "portfolio.hpp"
+#include "library.hpp"
+#include "tempering.hpp"
+#include "random.hpp"
+#include "telemetry.hpp"
+
+// Work with ID that Motocoin-Qt gave to it. ID is zero if work came as hex line,
+// then answers about it are hex lines too, otherwise they are binary frames.
+struct CJob : MotoWork
+{
+	uint32_t JobId;
+};
+
+// Current work. Old work is released (reported to Motocoin-Qt) when last worker stops using it.
+// All work is CJob.
+static shared_ptr<const MotoWork> g_pWork;
+static mutex g_WorkMutex;
+static condition_variable g_WorkCondition;
+
+// Incremented when new block is found, all work in progress becomes useless.
+// Workers check it between candidates, so stale work is abandoned at once.
+static atomic<unsigned int> g_TipEpoch(0);
+
+// When g_TipEpoch was incremented last time (steady_clock ticks), to measure time spent on stale work.
+static atomic<int64_t> g_EpochTime(0);
+
+static mutex g_OutputMutex;
+
+// Work server given with -connect, empty if we talk to Motocoin-Qt via stdio.
+static string g_ServerHost;
+static string g_ServerPort = "13107";
+
+// Connection to work server, guarded by g_OutputMutex. Output is dropped while there is no connection.
+static SOCKET g_Socket = INVALID_SOCKET;
+
+// More workers than this is surely a typo in -threads.
+static const int g_MaxThreads = 1024;
+
+// Name of search strategy used by all workers.
+static string g_Strategy = "annealing";
+
+// Number of worlds searched by each worker at once.
+static int g_NumWorlds = CPortfolio::DefaultNumWorlds;
+
+// Print stats of each world to stderr when it is solved or abandoned.
+static bool g_PrintStats = false;
+
+// Solutions found by all workers, new worlds start from solutions of similar worlds.
+// Used only if file to keep it between runs is given.
+static CSolutionLibrary g_Library;
+static string g_LibraryPath;
+
+// Search in each world is recorded if file for it is given.
+static CTelemetryLog g_Telemetry;
+static string g_TelemetryPath;
+
+// Seed of the whole run, each worker gets its own seed derived from it.
+// With one worker the same seed and work give the same search.
+static uint64_t g_Seed;
+
+// Chains of parallel tempering (one per worker) if all workers search the same world.
+static CTemperingGroup* g_pTempering = NULL;
+
+static void print(const string& Msg)
+{
+	unique_lock<mutex> Lock(g_OutputMutex);
+	if (g_ServerHost.empty())
+	{
+		cout << Msg << flush;
+		return;
+	}
+
+	size_t Pos = 0;
+	while (g_Socket != INVALID_SOCKET && Pos < Msg.size())
+	{
+		int Size = (int)send(g_Socket, Msg.data() + Pos, (int)(Msg.size() - Pos), 0);
+		if (Size <= 0)
+		{
+			// Reading thread sees it and reconnects.
+			shutdown(g_Socket, SHUT_RDWR);
+			break;
+		}
+		Pos += Size;
+	}
+}
+
+// Inform Motocoin-Qt that we abandoned this work.
+static void releaseWork(const MotoWork* pWork)
+{
+	const CJob* pJob = static_cast<const CJob*>(pWork);
+	print(pJob->JobId != 0 ? motoCancelFrame(pJob->JobId) : motoMessage(*pWork));
+	delete pJob;
+}
+
+// Must be called under g_WorkMutex together with change of g_pWork,
+// so that workers never see new epoch with old work.
+static void nextEpoch()
+{
+	g_EpochTime = (int64_t)steady_clock::now().time_since_epoch().count();
+	g_TipEpoch++;
+}
+
+// Time since work became stale until worker noticed it.
+static void printStale()
+{
+	steady_clock::duration Stale(steady_clock::now().time_since_epoch().count() - g_EpochTime);
+	fprintf(stderr, "stale %.3f ms\n", duration_cast<microseconds>(Stale).count()/1000.0);
+}
+
+// Work and epoch it belongs to are read together.
+static shared_ptr<const MotoWork> waitForWork(unsigned int* pEpoch)
+{
+	unique_lock<mutex> Lock(g_WorkMutex);
+	while (!g_pWork)
+		g_WorkCondition.wait(Lock);
+	*pEpoch = g_TipEpoch;
+	return g_pWork;
+}
+
+static void setWork(const MotoWork& Work, uint32_t JobId)
+{
+	CJob* pJob = new CJob;
+	static_cast<MotoWork&>(*pJob) = Work;
+	pJob->JobId = JobId;
+	shared_ptr<const MotoWork> pWork(pJob, releaseWork);
+
+	unique_lock<mutex> Lock(g_WorkMutex);
+	if (Work.IsNew)
+		nextEpoch();
+	g_pWork = pWork;
+	g_WorkCondition.notify_all();
+}
+
+// Motocoin-Qt doesn't need solutions of this job anymore. If it is current work
+// workers drop all their worlds and wait for the next work.
+static void cancelWork(uint32_t JobId)
+{
+	unique_lock<mutex> Lock(g_WorkMutex);
+	if (!g_pWork || static_cast<const CJob&>(*g_pWork).JobId != JobId)
+		return;
+	nextEpoch();
+	g_pWork.reset();
+}
+
+// Connection to work server was lost, job IDs it gave mean nothing to the next connection.
+static void dropWork()
+{
+	unique_lock<mutex> Lock(g_WorkMutex);
+	if (!g_pWork)
+		return;
+	nextEpoch();
+	g_pWork.reset();
+}
+
+static bool processSolution(const MotoWork& Work, MotoPoW PoW)
+{
+	if (!(PoW.NumFrames < Work.TimeTarget && motoCheck(Work.Block, &PoW)))
+	{
+		print("Error: Rechecking solution failed!\n");
+		return false;
+	}
+
+	// Print solution, it will be parsed by Motocoin-Qt.
+	uint32_t JobId = static_cast<const CJob&>(Work).JobId;
+	if (JobId != 0)
+		print(motoFrame(JobId, PoW));
+	else
+		print(motoMessage(Work, PoW));
+	return true;
+}
+
+static void printStats(const CWorldStats& Stats)
+{
+	static const char* pEnds[] = { "active", "solved", "exhausted", "stagnated", "dropped" };
+	fprintf(stderr, "world %u %s candidates=%llu slices=%llu best=%lld rate=%.3f\n", Stats.Nonce, pEnds[Stats.End],
+		(unsigned long long)Stats.NumCandidates, (unsigned long long)Stats.NumSlices, (long long)Stats.BestDistSq, Stats.Rate);
+}
+
+// Worlds of previous block (or of cancelled work) are useless.
+static void dropWorlds(CPortfolio& Portfolio)
+{
+	uint64_t NumDropped = Portfolio.getNumEnded(WORLD_DROPPED);
+	Portfolio.clear();
+	Portfolio.setWork(shared_ptr<const MotoWork>());
+	if (g_PrintStats && Portfolio.getNumEnded(WORLD_DROPPED) > NumDropped)
+		printStale();
+}
+
+static void solve(uint64_t Seed)
+{
+	CPortfolio Portfolio(g_Strategy, Seed, g_NumWorlds, g_LibraryPath.empty() ? NULL : &g_Library,
+		g_TelemetryPath.empty() ? NULL : &g_Telemetry);
+	unsigned int TipEpoch = g_TipEpoch;
+	Portfolio.setEpoch(&g_TipEpoch, TipEpoch);
+
+	while (true)
+	{
+		// When work is updated for the same block, worlds that were started are kept
+		// and new ones are generated for the latest work.
+		// Work is released before waiting, so that cancelled work is reported at once.
+		if (g_TipEpoch != TipEpoch)
+			dropWorlds(Portfolio);
+		unsigned int Epoch;
+		shared_ptr<const MotoWork> pWork = waitForWork(&Epoch);
+		if (Epoch != TipEpoch)
+		{
+			dropWorlds(Portfolio);
+			TipEpoch = Epoch;
+			Portfolio.setEpoch(&g_TipEpoch, TipEpoch);
+		}
+		Portfolio.setWork(pWork);
+
+		EBruteResult Result = Portfolio.step();
+		if (Result == BRUTE_SUCCESS)
+			processSolution(*Portfolio.getWork(), Portfolio.getPoW());
+		if (Result != BRUTE_CONTINUE && g_PrintStats)
+			printStats(Portfolio.getLastEnded());
+	}
+}
+
+// Worker of parallel tempering, all workers search the same world.
+static void temper(int Chain, uint64_t Seed)
+{
+	CBruteForce Brute(new CTempering(g_pTempering, Chain, Seed));
+	shared_ptr<const MotoWork> pWork;
+	unsigned int WorldEpoch = 0;
+	uint32_t Generation = 0;
+
+	while (true)
+	{
+		// World of previous block is useless, the first chain that notices it moves all chains to another world.
+		if (Generation == 0 || WorldEpoch != g_TipEpoch)
+		{
+			if (Generation != 0 && g_PrintStats)
+				printStale();
+			unsigned int Epoch;
+			shared_ptr<const MotoWork> pNextWork = waitForWork(&Epoch);
+			g_pTempering->nextWorld(Generation, pNextWork, Epoch);
+		}
+		if (g_pTempering->getGeneration() != Generation)
+		{
+			Generation = g_pTempering->startWorld(&Brute, &pWork, &WorldEpoch);
+			Brute.setEpoch(&g_TipEpoch, WorldEpoch);
+		}
+
+		EBruteResult Result = Brute.step();
+		if (Result == BRUTE_SUCCESS)
+			processSolution(*pWork, Brute.getPoW());
+		if (Result != BRUTE_CONTINUE)
+		{
+			unsigned int Epoch;
+			shared_ptr<const MotoWork> pNextWork = waitForWork(&Epoch);
+			g_pTempering->nextWorld(Generation, pNextWork, Epoch);
+		}
+	}
+}
+
+// Handles data from Motocoin-Qt or from work server.
+static void processInput(CMotoReader& Reader, const char* pData, int Size)
+{
+	Reader.append(pData, Size);
+	MotoMessage Msg;
+	while (Reader.next(Msg))
+	{
+		// Work server answers our hello, its answer is not answered back.
+		if (Msg.Type == MOTO_MSG_HELLO && Msg.Version == MOTO_FRAME_VERSION && g_ServerHost.empty())
+			print(motoHelloMessage());
+		else if (Msg.Type == MOTO_MSG_WORK)
+			setWork(Msg.Work, Msg.JobId);
+		else if (Msg.Type == MOTO_MSG_CANCEL)
+			cancelWork(Msg.JobId);
+	}
+}
+
+static SOCKET connectToServer()
+{
+	addrinfo Hints;
+	memset(&Hints, 0, sizeof(Hints));
+	Hints.ai_family = AF_UNSPEC;
+	Hints.ai_socktype = SOCK_STREAM;
+	addrinfo* pAddresses = NULL;
+	if (getaddrinfo(g_ServerHost.c_str(), g_ServerPort.c_str(), &Hints, &pAddresses) != 0)
+		return INVALID_SOCKET;
+
+	SOCKET Socket = INVALID_SOCKET;
+	for (addrinfo* pAddress = pAddresses; pAddress && Socket == INVALID_SOCKET; pAddress = pAddress->ai_next)
+	{
+		Socket = socket(pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol);
+		if (Socket != INVALID_SOCKET && connect(Socket, pAddress->ai_addr, (int)pAddress->ai_addrlen) != 0)
+		{
+			closesocket(Socket);
+			Socket = INVALID_SOCKET;
+		}
+	}
+	freeaddrinfo(pAddresses);
+
+	// Solutions are small and must reach the node at once.
+	if (Socket != INVALID_SOCKET)
+	{
+		int NoDelay = 1;
+		setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&NoDelay, sizeof(NoDelay));
+	}
+	return Socket;
+}
+
+// Works for the node until killed, lost connection is restored.
+static void runClient()
+{
+#ifdef _WIN32
+	WSADATA WsaData;
+	WSAStartup(MAKEWORD(2, 2), &WsaData);
+#else
+	// Write to closed connection must not kill us, it is handled as error.
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	while (true)
+	{
+		SOCKET Socket = connectToServer();
+		if (Socket == INVALID_SOCKET)
+		{
+			fprintf(stderr, "Error: failed to connect to %s:%s, retrying in 5 seconds.\n", g_ServerHost.c_str(), g_ServerPort.c_str());
+			this_thread::sleep_for(seconds(5));
+			continue;
+		}
+		fprintf(stderr, "connected to %s:%s\n", g_ServerHost.c_str(), g_ServerPort.c_str());
+
+		{
+			unique_lock<mutex> Lock(g_OutputMutex);
+			g_Socket = Socket;
+		}
+		print(motoHelloMessage());
+
+		CMotoReader Reader;
+		char Data[4096];
+		int Size;
+		while ((Size = (int)recv(Socket, Data, sizeof(Data), 0)) > 0)
+			processInput(Reader, Data, Size);
+
+		{
+			unique_lock<mutex> Lock(g_OutputMutex);
+			g_Socket = INVALID_SOCKET;
+		}
+		closesocket(Socket);
+		dropWork();
+		fprintf(stderr, "Error: connection to %s:%s lost, reconnecting.\n", g_ServerHost.c_str(), g_ServerPort.c_str());
+		this_thread::sleep_for(seconds(1));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int NumThreads = (int)thread::hardware_concurrency();
+	bool Tempering = false;
+	g_Seed = (uint64_t)system_clock::now().time_since_epoch().count();
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "-threads=", 9) == 0)
+			NumThreads = atoi(argv[i] + 9);
+		else if (strncmp(argv[i], "-strategy=", 10) == 0)
+			g_Strategy = argv[i] + 10;
+		else if (strncmp(argv[i], "-worlds=", 8) == 0)
+			g_NumWorlds = atoi(argv[i] + 8);
+		else if (strcmp(argv[i], "-stats") == 0)
+			g_PrintStats = true;
+		else if (strncmp(argv[i], "-library=", 9) == 0)
+			g_LibraryPath = argv[i] + 9;
+		else if (strcmp(argv[i], "-tempering") == 0)
+			Tempering = true;
+		else if (strncmp(argv[i], "-seed=", 6) == 0)
+			g_Seed = strtoull(argv[i] + 6, NULL, 10);
+		else if (strncmp(argv[i], "-telemetry=", 11) == 0)
+			g_TelemetryPath = argv[i] + 11;
+		else if (strncmp(argv[i], "-connect=", 9) == 0)
+		{
+			// <host>[:<port>], port may be omitted for default work server port.
+			g_ServerHost = argv[i] + 9;
+			size_t Colon = g_ServerHost.rfind(':');
+			if (Colon != string::npos && g_ServerHost.find(':') == Colon)
+			{
+				g_ServerPort = g_ServerHost.substr(Colon + 1);
+				g_ServerHost.resize(Colon);
+			}
+		}
+	}
+	if (NumThreads < 0 || NumThreads > g_MaxThreads)
+	{
+		fprintf(stderr, "Error: invalid number of threads %d, must be from 0 to %d.\n", NumThreads, g_MaxThreads);
+		return 1;
+	}
+	if (!unique_ptr<CSearchStrategy>(createSearchStrategy(g_Strategy, 0)))
+	{
+		fprintf(stderr, "Error: unknown search strategy %s, use annealing, genetic or beam.\n", g_Strategy.c_str());
+		return 1;
+	}
+	if (!g_LibraryPath.empty())
+	{
+		int NumSkipped = g_Library.open(g_LibraryPath);
+		if (NumSkipped != 0)
+			fprintf(stderr, "Warning: skipped %d bad lines of solution library %s.\n", NumSkipped, g_LibraryPath.c_str());
+	}
+	if (!g_TelemetryPath.empty())
+	{
+		// Chains of parallel tempering don't search worlds on their own, there is nothing to record per world.
+		if (Tempering)
+		{
+			fprintf(stderr, "Error: -telemetry can't be used with -tempering.\n");
+			return 1;
+		}
+		if (!g_Telemetry.open(g_TelemetryPath))
+		{
+			fprintf(stderr, "Error: failed to open telemetry log %s.\n", g_TelemetryPath.c_str());
+			return 1;
+		}
+	}
+	if (NumThreads == 0)
+		NumThreads = 1;
+
+	// Print seed, so that run can be repeated with -seed.
+	if (g_PrintStats)
+		fprintf(stderr, "seed %llu\n", (unsigned long long)g_Seed);
+	CRandom Seeds(g_Seed);
+
+	// Workers are never stopped, process is terminated when Motocoin-Qt closes our stdin
+	// or, with -connect, when it is killed.
+	CTemperingGroup TemperingGroup(Tempering ? NumThreads : 1, Seeds.next64());
+	if (Tempering)
+	{
+		g_pTempering = &TemperingGroup;
+		for (int i = 0; i < NumThreads; i++)
+			thread(temper, i, Seeds.next64()).detach();
+	}
+	else
+	{
+		for (int i = 0; i < NumThreads; i++)
+			thread(solve, Seeds.next64()).detach();
+	}
+
+	if (!g_ServerHost.empty())
+		runClient();
+
+	// Frames may contain any bytes, they must not be translated.
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	CMotoReader Reader;
+	while (true)
+	{
+		char Data[4096];
+#ifdef _WIN32
+		int Size = _read(_fileno(stdin), Data, sizeof(Data));
+#else
+		int Size = (int)read(STDIN_FILENO, Data, sizeof(Data));
+#endif
+		if (Size <= 0)
+			break;
+		processInput(Reader, Data, Size);
+	}
+
+#ifdef _WIN32
+	TerminateProcess(GetCurrentProcess(), 0);
+#else
+	_exit(0);
+#endif
+	return 0;
+}
@@ -0,0 +1,62 @@
+#-------------------------------------------------
+#
+# Headless solver, doesn't need OpenGL nor GLFW.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = motosolver
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += \
+    sha512.cpp \
+    brute.cpp \
+    search.cpp \
+    input.cpp \
+    anneal.cpp \
+    genetic.cpp \
+    beam.cpp \
+    field.cpp \
+    portfolio.cpp \
+    library.cpp \
+    tempering.cpp \
+    telemetry.cpp \
+    solver.cpp \
+    ../moto-engine.cpp \
+    ../moto-sha512.cpp \
+    ../moto-protocol.cpp
+
+HEADERS += \
+    brute.hpp \
+    search.hpp \
+    input.hpp \
+    random.hpp \
+    anneal.hpp \
+    genetic.hpp \
+    beam.hpp \
+    field.hpp \
+    portfolio.hpp \
+    library.hpp \
+    tempering.hpp \
+    telemetry.hpp \
+    ../moto-engine.h \
+    ../moto-sha512.h \
+    ../moto-protocol.h \
+    sha512.h \
+    debug.h
+
+OTHER_FILES += \
+    build-solver-linux.sh
+QMAKE_CXXFLAGS+=-std=c++11
+QMAKE_CXXFLAGS_DEBUG -= -O2
+
+DEFINES += NO_OPENSSL_SHA
+INCLUDEPATH += .
+
+LIBS+=-lpthread
+win32:LIBS += -lws2_32
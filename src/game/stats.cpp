@@ -0,0 +1,230 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Summary of telemetry logs written by motosolver -telemetry=<file>:
+// rates, outcomes of worlds and percentiles of effort, for each
+// strategy separately. It is used to tune search parameters.
+//--------------------------------------------------------------------
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "telemetry.hpp"
+#include "search.hpp"
+#include "portfolio.hpp"
+
+static const char* g_pEnds[] = { "active", "solved", "exhausted", "stagnated", "dropped" };
+static const int g_NumEnds = sizeof(g_pEnds)/sizeof(g_pEnds[0]);
+
+static const int64_t g_Thresholds[] = { CSearchStrategy::NearDistSq, CSearchStrategy::CloseDistSq, CSearchStrategy::VeryCloseDistSq };
+static const char* g_pThresholds[] = { "near", "close", "very close" };
+static const int g_NumThresholds = sizeof(g_Thresholds)/sizeof(g_Thresholds[0]);
+
+static const double g_Percentiles[] = { 10, 50, 90, 99 };
+static const int g_NumPercentiles = sizeof(g_Percentiles)/sizeof(g_Percentiles[0]);
+
+// Values of one quantity, percentiles are printed when all of them are collected.
+class CDistribution
+{
+public:
+	void add(double Value) { m_Values.push_back(Value); }
+
+	void print(const char* pName)
+	{
+		printf("  %-28s", pName);
+		if (m_Values.empty())
+		{
+			printf(" no data\n");
+			return;
+		}
+		sort(m_Values.begin(), m_Values.end());
+		for (int i = 0; i < g_NumPercentiles; i++)
+		{
+			// Nearest rank.
+			size_t Rank = (size_t)(g_Percentiles[i]/100*m_Values.size() + 0.5);
+			double Value = m_Values[min(m_Values.size() - 1, Rank > 0 ? Rank - 1 : 0)];
+			printf(" p%02.0f=%-12.6g", g_Percentiles[i], Value);
+		}
+		printf(" n=%u\n", (unsigned int)m_Values.size());
+	}
+
+private:
+	vector<double> m_Values;
+};
+
+struct CSummary
+{
+	uint64_t NumWorlds;
+	uint64_t NumEnded[g_NumEnds];
+	uint64_t NumCandidates;
+	uint64_t NumFrames;
+	uint64_t NumNonces;
+	double Seconds;
+
+	// Worlds that got through threshold and how many of them were solved.
+	uint64_t NumReached[g_NumThresholds];
+	uint64_t NumSolvedReached[g_NumThresholds];
+
+	CDistribution SolveSeconds;
+	CDistribution SolveCandidates;
+	CDistribution FailCandidates;
+	CDistribution Nonces;
+	CDistribution SolvedStartDist;
+	CDistribution FailedStartDist;
+	CDistribution FailedBestDist;
+	CDistribution EndTemperature;
+	CDistribution ReachCandidates[g_NumThresholds];
+	CDistribution ReachTemperature[g_NumThresholds];
+
+	CSummary() : NumWorlds(0), NumCandidates(0), NumFrames(0), NumNonces(0), Seconds(0)
+	{
+		memset(NumEnded, 0, sizeof(NumEnded));
+		memset(NumReached, 0, sizeof(NumReached));
+		memset(NumSolvedReached, 0, sizeof(NumSolvedReached));
+	}
+};
+
+// Distances are printed as square roots, they are easier to compare with thresholds.
+static double getDist(int64_t DistSq)
+{
+	return sqrt((double)max<int64_t>(DistSq, 0));
+}
+
+static void add(CSummary& Summary, const CTelemetryWorld& World)
+{
+	bool Solved = (World.End == WORLD_SOLVED);
+	Summary.NumWorlds++;
+	if (World.End < g_NumEnds)
+		Summary.NumEnded[World.End]++;
+	Summary.NumCandidates += World.NumCandidates;
+	Summary.NumFrames += World.NumFrames;
+	Summary.NumNonces += World.NumNonces;
+	Summary.Seconds += World.Milliseconds/1000.0;
+	Summary.Nonces.add(World.NumNonces);
+
+	if (Solved)
+	{
+		Summary.SolveSeconds.add(World.Milliseconds/1000.0);
+		Summary.SolveCandidates.add((double)World.NumCandidates);
+		Summary.SolvedStartDist.add(getDist(World.StartDistSq));
+	}
+	else if (World.End != WORLD_DROPPED)
+	{
+		Summary.FailCandidates.add((double)World.NumCandidates);
+		Summary.FailedStartDist.add(getDist(World.StartDistSq));
+		Summary.FailedBestDist.add(getDist(World.BestDistSq));
+		Summary.EndTemperature.add(World.Temperature);
+	}
+
+	// The first progress point below each threshold.
+	for (int k = 0; k < g_NumThresholds; k++)
+	{
+		const CTelemetryPoint* pReached = NULL;
+		for (const CTelemetryPoint& Point : World.Progress)
+			if (Point.BestDistSq < g_Thresholds[k])
+			{
+				pReached = &Point;
+				break;
+			}
+		if (!pReached && !Solved)
+			continue;
+
+		Summary.NumReached[k]++;
+		if (Solved)
+			Summary.NumSolvedReached[k]++;
+		Summary.ReachCandidates[k].add(pReached ? (double)pReached->NumCandidates : (double)World.NumCandidates);
+		if (pReached)
+			Summary.ReachTemperature[k].add(pReached->Temperature);
+	}
+}
+
+static void print(const string& Strategy, CSummary& Summary)
+{
+	printf("strategy %s\n", Strategy.c_str());
+	printf("  worlds %llu:", (unsigned long long)Summary.NumWorlds);
+	for (int i = 0; i < g_NumEnds; i++)
+		if (Summary.NumEnded[i] > 0)
+			printf(" %s %llu (%.1f%%)", g_pEnds[i], (unsigned long long)Summary.NumEnded[i], 100.0*Summary.NumEnded[i]/Summary.NumWorlds);
+	printf("\n");
+
+	double Seconds = max(Summary.Seconds, 1e-9);
+	printf("  search time %.1f s (sum over workers), solutions per hour %.1f\n", Summary.Seconds, Summary.NumEnded[WORLD_SOLVED]*3600/Seconds);
+	printf("  candidates/s %.1f, frames/s %.0f, frames/candidate %.1f, nonces/world %.1f\n",
+		Summary.NumCandidates/Seconds, Summary.NumFrames/Seconds,
+		Summary.NumCandidates > 0 ? (double)Summary.NumFrames/Summary.NumCandidates : 0.0,
+		Summary.NumWorlds > 0 ? (double)Summary.NumNonces/Summary.NumWorlds : 0.0);
+	if (Summary.NumEnded[WORLD_SOLVED] > 0)
+		printf("  candidates per solution %.0f (including worlds that were abandoned)\n", (double)Summary.NumCandidates/Summary.NumEnded[WORLD_SOLVED]);
+
+	for (int k = 0; k < g_NumThresholds; k++)
+		printf("  %-10s (dist < %.0f): reached by %llu worlds (%.1f%%), %.1f%% of them solved\n", g_pThresholds[k], getDist(g_Thresholds[k]),
+			(unsigned long long)Summary.NumReached[k], Summary.NumWorlds > 0 ? 100.0*Summary.NumReached[k]/Summary.NumWorlds : 0.0,
+			Summary.NumReached[k] > 0 ? 100.0*Summary.NumSolvedReached[k]/Summary.NumReached[k] : 0.0);
+
+	Summary.SolveSeconds.print("seconds to solution");
+	Summary.SolveCandidates.print("candidates to solution");
+	Summary.FailCandidates.print("candidates in failed world");
+	Summary.EndTemperature.print("temperature at failure");
+	Summary.Nonces.print("nonces scanned per world");
+	Summary.SolvedStartDist.print("start dist of solved");
+	Summary.FailedStartDist.print("start dist of failed");
+	Summary.FailedBestDist.print("best dist of failed");
+	for (int k = 0; k < g_NumThresholds; k++)
+	{
+		string Name = string("candidates to ") + g_pThresholds[k];
+		Summary.ReachCandidates[k].print(Name.c_str());
+		Name = string("temperature at ") + g_pThresholds[k];
+		Summary.ReachTemperature[k].print(Name.c_str());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* pOnly = NULL;
+	vector<const char*> Paths;
+	bool Usage = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "-strategy=", 10) == 0)
+			pOnly = argv[i] + 10;
+		else if (argv[i][0] != '-')
+			Paths.push_back(argv[i]);
+		else
+			Usage = true;
+	}
+	if (Usage || Paths.empty())
+	{
+		fprintf(stderr, "Usage: motostats [-strategy=NAME] <telemetry log>...\n");
+		return 1;
+	}
+
+	map<string, CSummary> Summaries;
+	for (const char* pPath : Paths)
+	{
+		CTelemetryReader Reader;
+		if (!Reader.open(pPath))
+		{
+			fprintf(stderr, "Error: %s is not a telemetry log.\n", pPath);
+			return 1;
+		}
+		CTelemetryWorld World;
+		while (Reader.read(&World))
+			if (!pOnly || World.Strategy == pOnly)
+				add(Summaries[World.Strategy], World);
+	}
+
+	for (map<string, CSummary>::iterator it = Summaries.begin(); it != Summaries.end(); ++it)
+		print(it->first, it->second);
+	return 0;
+}
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Summary of solver telemetry logs, doesn't need OpenGL nor GLFW.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = motostats
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += \
+    telemetry.cpp \
+    stats.cpp
+
+HEADERS += \
+    telemetry.hpp \
+    search.hpp \
+    portfolio.hpp \
+    ../moto-engine.h
+
+OTHER_FILES += \
+    build-stats-linux.sh
+QMAKE_CXXFLAGS+=-std=c++11
+QMAKE_CXXFLAGS_DEBUG -= -O2
+
+INCLUDEPATH += .
@@ -0,0 +1,166 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Binary log of search in each world.
+//--------------------------------------------------------------------
+
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+#include "telemetry.hpp"
+
+const char* const CTelemetryLog::Magic = "MOTOTEL1";
+static const size_t g_MagicSize = 8;
+static const size_t g_MaxStrategyName = 255;
+
+static void put(vector<uint8_t>& Data, uint64_t Value, int Size)
+{
+	for (int i = 0; i < Size; i++)
+		Data.push_back((uint8_t)(Value >> 8*i));
+}
+
+// Reads from record, reading past its end sets error flag.
+class CRecordReader
+{
+public:
+	CRecordReader(const vector<uint8_t>& Data) : m_Data(Data), m_Pos(0), m_Error(false) {}
+
+	uint64_t get(int Size)
+	{
+		if (m_Pos + Size > m_Data.size())
+		{
+			m_Error = true;
+			return 0;
+		}
+		uint64_t Value = 0;
+		for (int i = 0; i < Size; i++)
+			Value |= (uint64_t)m_Data[m_Pos++] << 8*i;
+		return Value;
+	}
+
+	string getString(size_t Size)
+	{
+		if (m_Pos + Size > m_Data.size())
+		{
+			m_Error = true;
+			return string();
+		}
+		string Value(m_Data.begin() + m_Pos, m_Data.begin() + m_Pos + Size);
+		m_Pos += Size;
+		return Value;
+	}
+
+	size_t getRemaining() const { return m_Data.size() - m_Pos; }
+	bool hasError() const { return m_Error; }
+
+private:
+	const vector<uint8_t>& m_Data;
+	size_t m_Pos;
+	bool m_Error;
+};
+
+static const size_t g_PointSize = 8 + 8 + 8 + 4 + 4;
+
+bool CTelemetryLog::open(const string& Path)
+{
+	unique_lock<mutex> Lock(m_Mutex);
+	m_File.open(Path.c_str(), ios::binary | ios::app);
+	if (!m_File.is_open())
+		return false;
+
+	// Magic is written only to new file.
+	m_File.seekp(0, ios::end);
+	if (m_File.tellp() == 0)
+	{
+		m_File.write(Magic, g_MagicSize);
+		m_File.flush();
+	}
+	return m_File.good();
+}
+
+void CTelemetryLog::write(const CTelemetryWorld& World)
+{
+	vector<uint8_t> Data;
+	size_t NameSize = min(World.Strategy.size(), g_MaxStrategyName);
+	put(Data, World.Nonce, 4);
+	put(Data, World.NumNonces, 4);
+	put(Data, World.StartDistSq, 8);
+	put(Data, World.TimeTarget, 2);
+	put(Data, World.End, 1);
+	put(Data, NameSize, 1);
+	Data.insert(Data.end(), World.Strategy.begin(), World.Strategy.begin() + NameSize);
+	put(Data, World.NumCandidates, 8);
+	put(Data, World.NumFrames, 8);
+	put(Data, World.BestDistSq, 8);
+	put(Data, World.Temperature, 4);
+	put(Data, World.Milliseconds, 4);
+	put(Data, World.Progress.size(), 4);
+	for (const CTelemetryPoint& Point : World.Progress)
+	{
+		put(Data, Point.NumCandidates, 8);
+		put(Data, Point.NumFrames, 8);
+		put(Data, Point.BestDistSq, 8);
+		put(Data, Point.Temperature, 4);
+		put(Data, Point.Milliseconds, 4);
+	}
+
+	vector<uint8_t> Size;
+	put(Size, Data.size(), 4);
+
+	unique_lock<mutex> Lock(m_Mutex);
+	m_File.write((const char*)&Size[0], Size.size());
+	m_File.write((const char*)&Data[0], Data.size());
+	m_File.flush();
+}
+
+bool CTelemetryReader::open(const string& Path)
+{
+	m_File.open(Path.c_str(), ios::binary);
+	char Header[g_MagicSize];
+	if (!m_File.read(Header, g_MagicSize))
+		return false;
+	return memcmp(Header, CTelemetryLog::Magic, g_MagicSize) == 0;
+}
+
+bool CTelemetryReader::read(CTelemetryWorld* pWorld)
+{
+	uint8_t SizeData[4];
+	if (!m_File.read((char*)SizeData, sizeof(SizeData)))
+		return false;
+	uint32_t Size = SizeData[0] | (SizeData[1] << 8) | (SizeData[2] << 16) | ((uint32_t)SizeData[3] << 24);
+	vector<uint8_t> Data(Size);
+	if (Size > 0 && !m_File.read((char*)&Data[0], Size))
+		return false;
+
+	CRecordReader Reader(Data);
+	pWorld->Nonce = (uint32_t)Reader.get(4);
+	pWorld->NumNonces = (uint32_t)Reader.get(4);
+	pWorld->StartDistSq = (int64_t)Reader.get(8);
+	pWorld->TimeTarget = (int16_t)Reader.get(2);
+	pWorld->End = (uint8_t)Reader.get(1);
+	pWorld->Strategy = Reader.getString((size_t)Reader.get(1));
+	pWorld->NumCandidates = Reader.get(8);
+	pWorld->NumFrames = Reader.get(8);
+	pWorld->BestDistSq = (int64_t)Reader.get(8);
+	pWorld->Temperature = (int32_t)Reader.get(4);
+	pWorld->Milliseconds = (uint32_t)Reader.get(4);
+	uint32_t NumPoints = (uint32_t)Reader.get(4);
+	if (Reader.hasError() || NumPoints > Reader.getRemaining()/g_PointSize)
+		return false;
+
+	pWorld->Progress.resize(NumPoints);
+	for (CTelemetryPoint& Point : pWorld->Progress)
+	{
+		Point.NumCandidates = Reader.get(8);
+		Point.NumFrames = Reader.get(8);
+		Point.BestDistSq = (int64_t)Reader.get(8);
+		Point.Temperature = (int32_t)Reader.get(4);
+		Point.Milliseconds = (uint32_t)Reader.get(4);
+	}
+	return !Reader.hasError();
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Binary log of search in each world, written by motosolver and
+// summarized by motostats. Search parameters are tuned from it.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_TELEMETRY_H
+#define MOTOGAME_TELEMETRY_H
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../moto-engine.h"
+
+// Progress of search in one world, recorded each time best distance improves.
+struct CTelemetryPoint
+{
+	uint64_t NumCandidates; // Since world was started.
+	uint64_t NumFrames;
+	int64_t BestDistSq;
+	int32_t Temperature;
+	uint32_t Milliseconds;  // Time spent in this world, time given to other worlds is not counted.
+};
+
+// Search in one world from its start until it was solved or abandoned.
+struct CTelemetryWorld
+{
+	uint32_t Nonce;
+	uint32_t NumNonces;     // Nonces scanned to find this world.
+	int64_t StartDistSq;    // Distance from start to finish through the sky, tells how hard the world is.
+	int16_t TimeTarget;
+	uint8_t End;            // EWorldEnd, see portfolio.hpp.
+	std::string Strategy;
+	uint64_t NumCandidates;
+	uint64_t NumFrames;
+	int64_t BestDistSq;
+	int32_t Temperature;    // When world ended.
+	uint32_t Milliseconds;
+	std::vector<CTelemetryPoint> Progress;
+};
+
+// File starts with magic, then each world is one record prefixed by its size,
+// so that readers can skip fields that are added later. Integers are little-endian.
+class CTelemetryLog
+{
+public:
+	static const char* const Magic; // "MOTOTEL1"
+
+	// Records are appended to existing file. Returns false if file can't be opened.
+	bool open(const std::string& Path);
+
+	// Thread-safe. Record is flushed at once, solver may be terminated at any moment.
+	void write(const CTelemetryWorld& World);
+
+private:
+	std::mutex m_Mutex;
+	std::ofstream m_File;
+};
+
+class CTelemetryReader
+{
+public:
+	// Returns false if file can't be opened or it is not telemetry log.
+	bool open(const std::string& Path);
+
+	// Next world, returns false at the end of file. Truncated last record (solver was killed while writing it) is ignored.
+	bool read(CTelemetryWorld* pWorld);
+
+private:
+	std::ifstream m_File;
+};
+
+#endif // MOTOGAME_TELEMETRY_H
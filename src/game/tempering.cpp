@@ -0,0 +1,205 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Parallel tempering search of proof-of-play.
+//--------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+#include "../moto-engine.h"
+#include "tempering.hpp"
+
+// Tempering parameters.
+static const int32_t g_ColdTemp = 40;       // Temperature of the coldest chain.
+static const int32_t g_HotTemp = 300;       // Temperature of the hottest chain.
+static const int32_t g_StartEffort = 100;   // Steps of the coldest chain in new world, fewer than annealing makes as other chains search it too.
+static const int32_t g_FirstEffort = 100;   // Steps added when it gets closer than one of thresholds.
+static const int32_t g_K = 7;               // Number of candidates evaluated in one step.
+static const int g_ExchangePeriod = 4;      // Steps between offers to colder neighbor.
+
+static const int64_t g_UnknownDistSq = ((int64_t)1) << 61;
+
+CTemperingGroup::CTemperingGroup(int NumChains, uint64_t Seed) :
+	m_NumChains(max(NumChains, 1)),
+	m_pSlots(new atomic<CState*>[2*max(NumChains, 1)]),
+	m_Generation(0),
+	m_Random(Seed)
+{
+	for (int i = 0; i < 2*m_NumChains; i++)
+		m_pSlots[i].store(NULL);
+	m_Epoch = 0;
+	memset(&m_World, 0, sizeof(m_World));
+	memset(&m_FirstFrame, 0, sizeof(m_FirstFrame));
+	m_Nonce = 0;
+}
+
+CTemperingGroup::~CTemperingGroup()
+{
+	for (int i = 0; i < 2*m_NumChains; i++)
+		delete m_pSlots[i].exchange(NULL);
+}
+
+int32_t CTemperingGroup::getTemperature(int Chain) const
+{
+	if (m_NumChains == 1)
+		return g_ColdTemp;
+	return (int32_t)(g_ColdTemp*pow((double)g_HotTemp/g_ColdTemp, (double)Chain/(m_NumChains - 1)) + 0.5);
+}
+
+void CTemperingGroup::nextWorld(uint32_t Generation, const shared_ptr<const MotoWork>& pWork, unsigned int Epoch)
+{
+	unique_lock<mutex> Lock(m_WorldMutex);
+	if (m_Generation.load() != Generation)
+		return;
+
+	// Some worlds are ill-formed.
+	MotoPoW PoW;
+	motoInitPoW(&PoW);
+	do
+		PoW.Nonce = m_Random.next();
+	while (!motoGenerateGoodWorld(&m_World, &m_FirstFrame, pWork->Block, &PoW));
+
+	m_pWork = pWork;
+	m_Epoch = Epoch;
+	m_Nonce = PoW.Nonce;
+	m_Generation.store(Generation + 1, memory_order_release);
+}
+
+uint32_t CTemperingGroup::startWorld(CBruteForce* pBrute, shared_ptr<const MotoWork>* pWork, unsigned int* pEpoch)
+{
+	unique_lock<mutex> Lock(m_WorldMutex);
+	*pWork = m_pWork;
+	*pEpoch = m_Epoch;
+	pBrute->start(*m_pWork, m_World, m_FirstFrame, m_Nonce);
+	return m_Generation.load();
+}
+
+void CTemperingGroup::post(int Chain, bool FromHotter, CState* pState)
+{
+	delete m_pSlots[2*Chain + (FromHotter ? 1 : 0)].exchange(pState);
+}
+
+CTemperingGroup::CState* CTemperingGroup::take(int Chain, bool FromHotter)
+{
+	// Don't write to the slot if there is nothing to take, it is checked at each step.
+	atomic<CState*>& Slot = m_pSlots[2*Chain + (FromHotter ? 1 : 0)];
+	if (!Slot.load(memory_order_relaxed))
+		return NULL;
+	return Slot.exchange(NULL);
+}
+
+CTempering::CTempering(CTemperingGroup* pGroup, int Chain, uint64_t Seed) :
+	CSearchStrategy(Seed),
+	m_pGroup(pGroup),
+	m_Chain(Chain)
+{
+	m_Generation = 0;
+	m_Horizon = MaxHorizon;
+	m_Temp = pGroup->getTemperature(Chain);
+	m_Effort = 0;
+	m_NumSteps = 0;
+	m_BestInput.reset(m_Horizon);
+	randomize(&m_BestInput);
+	m_BestDistSq = g_UnknownDistSq;
+	m_OfferedDistSq = g_UnknownDistSq;
+}
+
+void CTempering::start(const MotoWork& Work, const MotoWorld*, const CDistanceField*, const MotoState&)
+{
+	// It is called by CTemperingGroup::startWorld(), so generation can't change meanwhile.
+	m_Generation = m_pGroup->getGeneration();
+	m_Horizon = getHorizon(Work);
+	m_BestInput.setNumFrames(m_Horizon);
+	m_Effort = g_StartEffort;
+	m_NumSteps = 0;
+	m_BestDistSq = g_UnknownDistSq;
+	m_OfferedDistSq = g_UnknownDistSq;
+}
+
+int CTempering::beginStep()
+{
+	exchange();
+	m_NumSteps++;
+
+	// Only the coldest chain gives up, others follow it to the next world.
+	if (m_Chain == 0)
+	{
+		m_Effort--;
+		if (m_Effort <= 0)
+			return 0;
+	}
+
+	if (m_BestDistSq < CloseDistSq)
+		return 4*g_K;
+	if (m_BestDistSq < NearDistSq)
+		return 2*g_K;
+	return g_K;
+}
+
+void CTempering::propose(MotoPoW* pPoW)
+{
+	m_Input = m_BestInput;
+	mutate(&m_Input, m_Temp);
+	m_Input.getPoW(pPoW);
+}
+
+void CTempering::receive(int64_t DistSq)
+{
+	if (DistSq < m_BestDistSq)
+		accept(m_Input, DistSq);
+}
+
+void CTempering::accept(const CInput& Input, int64_t DistSq)
+{
+	// The coldest chain gets more time each time when it gets through one of thresholds, the same way as annealing is reheated.
+	if (m_Chain == 0)
+	{
+		if (DistSq < NearDistSq && m_BestDistSq > NearDistSq)
+			m_Effort += g_FirstEffort;
+		if (DistSq < CloseDistSq && m_BestDistSq > CloseDistSq)
+			m_Effort += g_FirstEffort;
+		if (DistSq < VeryCloseDistSq && m_BestDistSq > VeryCloseDistSq)
+			m_Effort += g_FirstEffort;
+	}
+
+	m_BestDistSq = DistSq;
+	m_BestInput = Input;
+}
+
+// Chains don't accept worse states, so states are swapped only if hotter one is better.
+void CTempering::exchange()
+{
+	unique_ptr<CTemperingGroup::CState> pHotter(m_pGroup->take(m_Chain, true));
+	if (pHotter && pHotter->Generation == m_Generation && pHotter->DistSq < m_BestDistSq)
+	{
+		CTemperingGroup::CState* pReply = new CTemperingGroup::CState;
+		pReply->Generation = m_Generation;
+		pReply->DistSq = m_BestDistSq;
+		pReply->Input = m_BestInput;
+		m_pGroup->post(m_Chain + 1, false, pReply);
+		accept(pHotter->Input, pHotter->DistSq);
+	}
+
+	// If this chain improved since its offer was sent, the swap turns into copy.
+	unique_ptr<CTemperingGroup::CState> pColder(m_pGroup->take(m_Chain, false));
+	if (pColder && pColder->Generation == m_Generation && m_BestDistSq == m_OfferedDistSq)
+		accept(pColder->Input, pColder->DistSq);
+
+	if (m_Chain > 0 && m_NumSteps % g_ExchangePeriod == 0 && m_BestDistSq != m_OfferedDistSq)
+	{
+		CTemperingGroup::CState* pOffer = new CTemperingGroup::CState;
+		pOffer->Generation = m_Generation;
+		pOffer->DistSq = m_BestDistSq;
+		pOffer->Input = m_BestInput;
+		m_pGroup->post(m_Chain - 1, true, pOffer);
+		m_OfferedDistSq = m_BestDistSq;
+	}
+}
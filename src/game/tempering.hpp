@@ -0,0 +1,111 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin.
+//--------------------------------------------------------------------
+// Parallel tempering: several annealing chains (one per worker) search
+// the same world, each at its own temperature, and swap their states.
+//--------------------------------------------------------------------
+
+#ifndef MOTOGAME_TEMPERING_H
+#define MOTOGAME_TEMPERING_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "../moto-engine.h"
+#include "search.hpp"
+#include "brute.hpp"
+#include "random.hpp"
+
+// Shared by chains of all workers. Chain 0 is the coldest one, it decides when world is exhausted.
+// Exchange of states never blocks, only moving to another world (which is rare) takes a lock.
+class CTemperingGroup
+{
+public:
+	// Best state of a chain sent to its neighbor.
+	struct CState
+	{
+		uint32_t Generation;
+		int64_t DistSq;
+		CInput Input;
+	};
+
+	// Seed is used to choose worlds, chains have their own seeds.
+	CTemperingGroup(int NumChains, uint64_t Seed);
+	~CTemperingGroup();
+
+	int getNumChains() const { return m_NumChains; }
+
+	// Temperatures are spread geometrically from the coldest chain to the hottest one.
+	int32_t getTemperature(int Chain) const;
+
+	// Incremented each time when chains move to another world, 0 until the first world.
+	uint32_t getGeneration() const { return m_Generation.load(std::memory_order_acquire); }
+
+	// Generate new world of given work for all chains, unless it was already done since Generation.
+	// Epoch is kept with the world, so that chains can tell when it becomes useless.
+	void nextWorld(uint32_t Generation, const std::shared_ptr<const MotoWork>& pWork, unsigned int Epoch);
+
+	// Start search of current world by one of chains, returns its generation.
+	// pWork (out) - work of the world, pEpoch (out) - epoch given to nextWorld().
+	uint32_t startWorld(CBruteForce* pBrute, std::shared_ptr<const MotoWork>* pWork, unsigned int* pEpoch);
+
+	// Each chain has one slot for state of its hotter neighbor and one for its colder neighbor.
+	// Slot takes ownership of posted state, unread state is replaced by newer one.
+	void post(int Chain, bool FromHotter, CState* pState);
+
+	// State posted to the chain or NULL, caller takes ownership of it.
+	CState* take(int Chain, bool FromHotter);
+
+private:
+	int m_NumChains;
+	std::unique_ptr<std::atomic<CState*>[]> m_pSlots;
+	std::atomic<uint32_t> m_Generation;
+
+	// Current world, protected by mutex.
+	std::mutex m_WorldMutex;
+	std::shared_ptr<const MotoWork> m_pWork;
+	unsigned int m_Epoch;
+	MotoWorld m_World;
+	MotoState m_FirstFrame;
+	uint32_t m_Nonce;
+	CRandom m_Random;
+};
+
+// One chain of parallel tempering. It is annealing at fixed temperature, so hot chains
+// explore and cold ones refine. Better states move to colder chains by swaps.
+class CTempering : public CSearchStrategy
+{
+public:
+	CTempering(CTemperingGroup* pGroup, int Chain, uint64_t Seed);
+
+	const char* getName() const { return "tempering"; }
+	void start(const MotoWork& Work, const MotoWorld* pWorld, const CDistanceField* pField, const MotoState& FirstFrame);
+	int beginStep();
+	void propose(MotoPoW* pPoW);
+	void receive(int64_t DistSq);
+	int64_t getBound() const { return m_BestDistSq; }
+	int32_t getTemperature() const { return m_Chain == 0 ? m_Effort : m_Temp; }
+
+private:
+	CTemperingGroup* m_pGroup;
+	int m_Chain;
+	uint32_t m_Generation;
+	int16_t m_Horizon;
+	int32_t m_Temp;
+	int32_t m_Effort; // Steps left until the coldest chain gives up.
+	int m_NumSteps;
+	CInput m_Input;
+	CInput m_BestInput;
+	int64_t m_BestDistSq;
+	int64_t m_OfferedDistSq; // Distance of state that was offered to colder neighbor.
+
+	void accept(const CInput& Input, int64_t DistSq);
+	void exchange();
+};
+
+#endif // MOTOGAME_TEMPERING_H
@@ -8,6 +8,8 @@
 #include "bitcoinrpc.h"
 #include "net.h"
 #include "init.h"
+#include "livetemplate.h"
+#include "workserver.h"
 #include "util.h"
 #include "ui_interface.h"
 
@@ -101,9 +103,11 @@ void Shutdown()
 
     RenameThread("bitcoin-shutoff");
     stopBTTrackers();
+    stopWorkServer();
     nTransactionsUpdated++;
     StopRPCThreads();
     ShutdownRPCMining();
+    stopLiveTemplate();
     if (pwalletMain)
         bitdb.Flush(false);
     StopNode();
@@ -361,6 +365,10 @@ std::string HelpMessage()
         "  -rpcconnect=<ip>       " + _("Send commands to node running on <ip> (default: 127.0.0.1)") + "\n" +
 #endif
         "  -rpcthreads=<n>        " + _("Set the number of threads to service RPC calls (default: 4)") + "\n" +
+        "  -workserver            " + _("Push work to solvers connected with motosolver -connect") + "\n" +
+        "  -workserverport=<port> " + _("Listen for solvers on <port> (default: 13107 or testnet: 26107)") + "\n" +
+        "  -workserverallowip=<ip>\n" +
+        "                         " + _("Allow solvers to connect from specified IP address") + "\n" +
         "  -blocknotify=<cmd>     " + _("Execute command when the best block changes (%s in cmd is replaced by block hash)") + "\n" +
         "  -walletnotify=<cmd>    " + _("Execute command when a wallet transaction changes (%s in cmd is replaced by TxID)") + "\n" +
         "  -spendzeroconfchange   " + _("Spend unconfirmed change when sending transactions (default: 1)") + "\n" +
@@ -1142,6 +1150,8 @@ bool AppInit2(boost::thread_group& threadGroup)
     }
 
     startBTTrackers();
+    startLiveTemplate();
+    startWorkServer();
 
     return !fRequestShutdown;
 }
@@ -0,0 +1,286 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// Live block template.
+//--------------------------------------------------------------------
+
+#include <set>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include "main.h"
+#include "wallet.h"
+#include "ui_interface.h"
+#include "livetemplate.h"
+
+static const int64 g_RebuildInterval = 60; // Seconds, skipped transactions wait for rebuild at most so long.
+static const int g_PollInterval = 500;     // Milliseconds, memory pool is checked for new transactions so often.
+
+// Template that is maintained, accessed only under cs_main and mempool.cs.
+// Its coinbase pays to nobody, copies get script of the caller.
+static boost::shared_ptr<CBlockTemplate> g_pBuild;
+static boost::shared_ptr<CCoinsViewCache> g_pView; // Tip with transactions of template applied.
+static std::set<uint256> g_Considered;             // Memory pool transactions that were added or skipped.
+static CBlockIndex* g_pPrev = NULL;
+static unsigned int g_TransactionsUpdated = 0;
+static unsigned int g_RebuildTransactionsUpdated = 0;
+static int64 g_LastRebuild = 0;
+static bool g_HasSkipped = false;                   // Some transactions wait for rebuild.
+static uint64 g_BlockSize = 0;
+static int64 g_BlockSigOps = 0;
+
+// Published copy, readers don't wait while template is being built.
+static CCriticalSection g_csLive;
+static boost::shared_ptr<const CBlockTemplate> g_pLive;
+static CBlockIndex* g_pLivePrev = NULL;
+static unsigned int g_Version = 0;
+static bool g_Requested = false; // Somebody wanted template that wasn't ready.
+
+static boost::thread g_Thread;
+static boost::mutex g_WakeMutex;
+static boost::condition_variable g_WakeCondition;
+static bool g_Wake = false;
+static boost::signals2::connection g_BlocksChanged;
+
+// Same limits as in CreateNewBlock.
+static unsigned int getBlockMaxSize()
+{
+    unsigned int MaxSize = GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
+    return std::max((unsigned int)1000, std::min((unsigned int)(MAX_BLOCK_SIZE-1000), MaxSize));
+}
+
+static void publish()
+{
+    boost::shared_ptr<const CBlockTemplate> pLive(new CBlockTemplate(*g_pBuild));
+    nLastBlockTx = g_pBuild->block.vtx.size() - 1;
+    nLastBlockSize = g_BlockSize;
+
+    LOCK(g_csLive);
+    g_pLive = pLive;
+    g_pLivePrev = g_pPrev;
+    g_Version++;
+    if (g_Version == 0)
+        g_Version = 1;
+}
+
+// Build template from scratch with priority rules of CreateNewBlock.
+static bool rebuild()
+{
+    g_pBuild.reset(CreateNewBlock(CScript() << OP_TRUE));
+    g_pView.reset();
+    g_Considered.clear();
+    if (!g_pBuild)
+        return false;
+
+    g_pPrev = pindexBest;
+    g_LastRebuild = GetTime();
+    g_RebuildTransactionsUpdated = nTransactionsUpdated;
+
+    // Coins of template transactions are spent in the view, so that transactions
+    // that arrive later are checked against the template as if it was connected.
+    CBlock& Block = g_pBuild->block;
+    g_pView.reset(new CCoinsViewCache(*pcoinsTip, true));
+    g_BlockSize = 1000;
+    g_BlockSigOps = 100;
+    for (unsigned int i = 1; i < Block.vtx.size(); i++)
+    {
+        const CTransaction& Tx = Block.vtx[i];
+        uint256 Hash = Tx.GetHash();
+        CValidationState State;
+        CTxUndo TxUndo;
+        Tx.UpdateCoins(State, *g_pView, TxUndo, g_pPrev->nHeight + 1, Hash);
+        g_BlockSize += ::GetSerializeSize(Tx, SER_NETWORK, PROTOCOL_VERSION);
+        g_BlockSigOps += g_pBuild->vTxSigOps[i];
+    }
+
+    // Whatever CreateNewBlock left out stays out until next rebuild.
+    for (std::map<uint256, CTransaction>::iterator mi = mempool.mapTx.begin(); mi != mempool.mapTx.end(); ++mi)
+        g_Considered.insert(mi->first);
+    g_HasSkipped = (mempool.mapTx.size() > Block.vtx.size() - 1);
+    return true;
+}
+
+// Append transactions that arrived to memory pool since template was built.
+// Only transactions that pay fee are appended, free ones wait for rebuild.
+static bool append()
+{
+    CBlock& Block = g_pBuild->block;
+
+    // Transaction of template was removed from memory pool, e.g. by conflicting one.
+    for (unsigned int i = 1; i < Block.vtx.size(); i++)
+        if (!mempool.mapTx.count(Block.vtx[i].GetHash()))
+            return rebuild();
+
+    unsigned int MaxSize = getBlockMaxSize();
+    int Height = g_pPrev->nHeight + 1;
+    bool Changed = false;
+    bool Progress = true;
+    while (Progress) // Transaction may depend on one that is later in memory pool.
+    {
+        Progress = false;
+        for (std::map<uint256, CTransaction>::iterator mi = mempool.mapTx.begin(); mi != mempool.mapTx.end(); ++mi)
+        {
+            const uint256& Hash = mi->first;
+            const CTransaction& Tx = mi->second;
+            if (g_Considered.count(Hash))
+                continue;
+
+            // Inputs are not known yet if transaction depends on one that isn't in template.
+            if (Tx.IsCoinBase() || !Tx.IsFinal() || !Tx.HaveInputs(*g_pView))
+                continue;
+            g_Considered.insert(Hash);
+
+            unsigned int TxSize = ::GetSerializeSize(Tx, SER_NETWORK, PROTOCOL_VERSION);
+            int64 TxFees = Tx.GetValueIn(*g_pView) - Tx.GetValueOut();
+            int64 TxSigOps = Tx.GetLegacySigOpCount() + Tx.GetP2SHSigOpCount(*g_pView);
+            if (g_BlockSize + TxSize >= MaxSize || g_BlockSigOps + TxSigOps >= MAX_BLOCK_SIGOPS ||
+                double(TxFees)/(double(TxSize)/1000.0) < CTransaction::nMinTxFee)
+            {
+                g_HasSkipped = true;
+                continue;
+            }
+
+            CValidationState State;
+            if (!Tx.CheckInputs(State, *g_pView, true, SCRIPT_VERIFY_P2SH))
+                continue;
+            CTxUndo TxUndo;
+            Tx.UpdateCoins(State, *g_pView, TxUndo, Height, Hash);
+
+            Block.vtx.push_back(Tx);
+            g_pBuild->vTxFees.push_back(TxFees);
+            g_pBuild->vTxSigOps.push_back(TxSigOps);
+            g_pBuild->vTxFees[0] -= TxFees;
+            Block.vtx[0].vout[0].nValue += TxFees;
+            g_BlockSize += TxSize;
+            g_BlockSigOps += TxSigOps;
+            Changed = Progress = true;
+        }
+    }
+    return Changed;
+}
+
+// Bring template up to date with tip and memory pool.
+static void refresh(bool Force)
+{
+    LOCK2(cs_main, mempool.cs);
+    if (pindexBest == NULL)
+        return;
+
+    // Don't build template for each block while catching up, unless somebody mines anyway.
+    if (!Force && IsInitialBlockDownload())
+    {
+        LOCK(g_csLive);
+        if (!g_Requested)
+            return;
+        g_Requested = false;
+    }
+
+    bool Changed = false;
+    if (!g_pBuild || g_pPrev != pindexBest)
+        Changed = rebuild();
+    else if (g_HasSkipped && nTransactionsUpdated != g_RebuildTransactionsUpdated && GetTime() - g_LastRebuild >= g_RebuildInterval)
+        Changed = rebuild();
+    else if (nTransactionsUpdated != g_TransactionsUpdated)
+        Changed = append();
+    g_TransactionsUpdated = nTransactionsUpdated;
+
+    if (Changed)
+        publish();
+}
+
+static void onBlocksChanged()
+{
+    boost::unique_lock<boost::mutex> Lock(g_WakeMutex);
+    g_Wake = true;
+    g_WakeCondition.notify_one();
+}
+
+static void threadLiveTemplate()
+{
+    RenameThread("bitcoin-livetemplate");
+    while (true)
+    {
+        {
+            boost::unique_lock<boost::mutex> Lock(g_WakeMutex);
+            if (!g_Wake)
+                g_WakeCondition.timed_wait(Lock, boost::posix_time::milliseconds(g_PollInterval));
+            g_Wake = false;
+        }
+
+        try
+        {
+            refresh(false);
+        }
+        catch (std::exception& e)
+        {
+            printf("LiveTemplate, ERROR: %s\n", e.what());
+        }
+    }
+}
+
+void startLiveTemplate()
+{
+    g_BlocksChanged = uiInterface.NotifyBlocksChanged.connect(onBlocksChanged);
+    g_Thread = boost::thread(threadLiveTemplate);
+}
+
+void stopLiveTemplate()
+{
+    g_BlocksChanged.disconnect();
+    g_Thread.interrupt();
+    if (g_Thread.joinable())
+        g_Thread.join();
+
+    LOCK2(cs_main, mempool.cs);
+    g_pView.reset();
+    g_pBuild.reset();
+}
+
+unsigned int getLiveTemplateVersion()
+{
+    LOCK(g_csLive);
+    return g_Version;
+}
+
+CBlockTemplate* getLiveTemplate(const CScript& ScriptPubKey, bool Wait, unsigned int* pVersion)
+{
+    boost::shared_ptr<const CBlockTemplate> pLive;
+    CBlockIndex* pPrev;
+    unsigned int Version;
+    for (int i = 0; i < 2; i++)
+    {
+        {
+            LOCK(g_csLive);
+            pLive = g_pLive;
+            pPrev = g_pLivePrev;
+            Version = g_Version;
+        }
+        if (pLive && pPrev == pindexBest)
+            break;
+        if (!Wait || i == 1)
+        {
+            LOCK(g_csLive);
+            g_Requested = true;
+            return NULL;
+        }
+        refresh(true);
+    }
+
+    CBlockTemplate* pTemplate = new CBlockTemplate(*pLive);
+    CBlock& Block = pTemplate->block;
+    Block.vtx[0].vout[0].scriptPubKey = ScriptPubKey;
+    pTemplate->vTxSigOps[0] = Block.vtx[0].GetLegacySigOpCount();
+    Block.UpdateTime(pPrev);
+    if (pVersion)
+        *pVersion = Version;
+    return pTemplate;
+}
+
+CBlockTemplate* getLiveTemplate(CReserveKey& ReserveKey, bool Wait, unsigned int* pVersion)
+{
+    CPubKey PubKey;
+    if (!ReserveKey.GetReservedKey(PubKey))
+        return NULL;
+    return getLiveTemplate(CScript() << PubKey << OP_CHECKSIG, Wait, pVersion);
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// Live block template.
+//--------------------------------------------------------------------
+// Node keeps one block template for current tip, so that Motocoin-Qt,
+// work server and mining RPCs don't rescan memory pool each time they
+// need work. Template is rebuilt in background thread right after new
+// tip is connected, transactions that arrive later are appended to it.
+//--------------------------------------------------------------------
+
+#ifndef MOTOCOIN_LIVETEMPLATE_H
+#define MOTOCOIN_LIVETEMPLATE_H
+
+#include "main.h"
+
+class CReserveKey;
+
+void startLiveTemplate();
+void stopLiveTemplate();
+
+// Incremented each time live template changes.
+unsigned int getLiveTemplateVersion();
+
+// Copy of live template with coinbase paying to given script, caller owns it.
+// If template for current tip isn't ready yet it is built at once when Wait is true,
+// otherwise NULL is returned. Version of the copy is stored to pVersion.
+CBlockTemplate* getLiveTemplate(const CScript& ScriptPubKey, bool Wait, unsigned int* pVersion = NULL);
+CBlockTemplate* getLiveTemplate(CReserveKey& ReserveKey, bool Wait, unsigned int* pVersion = NULL);
+
+#endif // MOTOCOIN_LIVETEMPLATE_H
@@ -48,9 +48,9 @@ using namespace std;
 
 #include "moto-engine.h"
 #include "moto-engine-const.h"
+#include "moto-sha512.h"
 
-/* Lookup tables. */
-static bool g_TablesInitialized = false;
+/* Lookup tables, they are built once during static initialization, before any thread can use them. */
 #define g_SqrtTableSize 150000
 static uint16_t g_s[0x10000];
 static uint16_t g_ds_div_2[0x10000];
@@ -141,10 +141,6 @@ static uint64_t isqrt(uint64_t num)
 
 static void initTables()
 {
-	if (g_TablesInitialized)
-		return;
-	g_TablesInitialized = true;
-
 	for (int64_t i = 0; i < 0x10000; i++)
 	{
 		g_s[i] = (uint16_t)((i*i*(3*65536 - 2*i)) >> 32);
@@ -155,14 +151,21 @@ static void initTables()
 		g_inv_sqrt[i] = (int32_t)(17592186036224/isqrt((i + 1)*68719476736));
 }
 
+class CInitTables
+{
+public:
+	CInitTables()
+	{
+		initTables();
+	}
+}
+instance_of_cinittables;
+
 static int16_t at8192_4096(const MotoWorld* pWorld, int16_t grad[2], const int32_t P[2])
 {
 	uint64_t x64 = (uint32_t)(P[0])*(int64_t)(MOTO_MAP_SIZE);
 	uint64_t y64 = (uint32_t)(P[1])*(int64_t)(MOTO_MAP_SIZE);
-	int i0 = x64 >> 32;
-	int i1 = (i0 + 1) % MOTO_MAP_SIZE;
-	int j0 = y64 >> 32;
-	int j1 = (j0 + 1) % MOTO_MAP_SIZE;
+	const MotoCell* pCell = &pWorld->Cells[x64 >> 32][y64 >> 32];
 
 	int32_t x = (x64 % 4294967296) >> 10;
 	int32_t y = (y64 % 4294967296) >> 10;
@@ -171,26 +174,18 @@ static int16_t at8192_4096(const MotoWorld* pWorld, int16_t grad[2], const int32
 	uint16_t sxsy = muluu(sx, sy);
 	uint16_t dsx_div_2 = g_ds_div_2[x >> 6];
 	uint16_t dsy_div_2 = g_ds_div_2[y >> 6];
-	int8_t x00 = pWorld->Map[i0][j0][0];
-	int8_t y00 = pWorld->Map[i0][j0][1];
-	int8_t x01 = pWorld->Map[i0][j1][0];
-	int8_t y01 = pWorld->Map[i0][j1][1];
-	int8_t x10 = pWorld->Map[i1][j0][0];
-	int8_t y10 = pWorld->Map[i1][j0][1];
-	int8_t x11 = pWorld->Map[i1][j1][0];
-	int8_t y11 = pWorld->Map[i1][j1][1];
-	int16_t Q00 = (x00*x + y00*y) >> 16;
-	int16_t Q01 = (x01*x + y01*(y - 4194304)) >> 16;
-	int16_t Q11 = (x11*(x - 4194304) + y11*(y - 4194304)) >> 16;
-	int16_t Q10 = (x10*(x - 4194304) + y10*y) >> 16;
+	int16_t Q00 = (pCell->x00*x + pCell->y00*y) >> 16;
+	int16_t Q01 = (pCell->x01*x + pCell->y01*(y - 4194304)) >> 16;
+	int16_t Q11 = (pCell->x11*(x - 4194304) + pCell->y11*(y - 4194304)) >> 16;
+	int16_t Q10 = (pCell->x10*(x - 4194304) + pCell->y10*y) >> 16;
 	int16_t Q1 = Q10 - Q00;
 	int16_t Q2 = Q01 - Q00;
 	int16_t Q3 = Q00 - Q01 - Q10 + Q11;
 	int16_t Q4 = Q2 + mulsu(Q3, sx);
 	int16_t Q5 = Q1 + mulsu(Q3, sy);
 	int16_t f = (Q00  + mulsu(Q1, sx) + mulsu(Q4, sy));
-	grad[0] = (((x00 + mulsu(x10 - x00, sx) + mulsu(x01 - x00, sy) + mulsu(x00 - x01 - x10 + x11, sxsy)) << 5) + mulsu(Q5, dsx_div_2));
-	grad[1] = (((y00 + mulsu(y10 - y00, sx) + mulsu(y01 - y00, sy) + mulsu(y00 - y01 - y10 + y11, sxsy)) << 5) + mulsu(Q4, dsy_div_2));
+	grad[0] = (((pCell->x00 + mulsu(pCell->x1, sx) + mulsu(pCell->x2, sy) + mulsu(pCell->x3, sxsy)) << 5) + mulsu(Q5, dsx_div_2));
+	grad[1] = (((pCell->y00 + mulsu(pCell->y1, sx) + mulsu(pCell->y2, sy) + mulsu(pCell->y3, sxsy)) << 5) + mulsu(Q4, dsy_div_2));
 
 	// ensure it is not zero
 	grad[0] |= 1;
@@ -199,6 +194,7 @@ static int16_t at8192_4096(const MotoWorld* pWorld, int16_t grad[2], const int32
 	return f;
 }
 
+/* Same as at8192_4096 without gradient, reads Map directly because it is used while world is still being generated. */
 static int16_t getF(const MotoWorld* pWorld, const int32_t P[2])
 {
     uint64_t x64 = (uint32_t)(P[0])*(int64_t)(MOTO_MAP_SIZE);
@@ -364,8 +360,6 @@ int64_t distSqp(const int32_t A[2], const int32_t B[2]){
 
 static EMotoResult advanceOneFrame(MotoState* pState, EMotoAccel Accel, EMotoRot Rotation, const MotoWorld* pWorld)
 {
-	initTables();
-
 	if (pState->Dead)
 		return MOTO_FAILURE;
 
@@ -566,56 +560,146 @@ EMotoResult motoAdvance(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorl
 
 
 
-bool motoGenerateRandomWorld(MotoWorld* pWorld, MotoState* pState, const uint8_t* pWork, MotoPoW* pow)
+/* World map is generated by SHA-512 in chunks, each chunk covers two columns of grid cells. */
+#define MOTO_MAP_CHUNK_SIZE (512/8)
+#define MOTO_MAP_NUM_CHUNKS (2*MOTO_MAP_SIZE*MOTO_MAP_SIZE/MOTO_MAP_CHUNK_SIZE)
+
+#if MOTO_MAP_NUM_CHUNKS % MOTO_SHA512_LANES != 0
+    #error "Number of world chunks must be multiple of number of SHA-512 lanes."
+#endif
+
+static void hashWorldChunk(MotoWorld* pWorld, uint8_t* pBlockPlusNonce, int iChunk)
 {
-    int32_t P[2];
-	initTables();
-    bool t=false;
-    int max_t=18,score=0,max_score=0,max_i=0,i,n=0;
+	pBlockPlusNonce[0] = iChunk;
+	SHA512(pBlockPlusNonce, MOTO_WORK_SIZE + 1 + sizeof(uint32_t), ((uint8_t*)pWorld->Map) + MOTO_MAP_CHUNK_SIZE*iChunk);
+}
 
-    uint8_t BlockPlusNonce[MOTO_WORK_SIZE + 1 + sizeof(uint32_t)];
-    memcpy(BlockPlusNonce + 1 + sizeof(uint32_t), pWork, MOTO_WORK_SIZE);
+/* Build coefficients of cells from Map. Must be called when Map is complete. */
+static void buildCells(MotoWorld* pWorld)
+{
+	memset(pWorld->Cells, 0, sizeof(pWorld->Cells));
+	for (int i0 = 0; i0 < MOTO_MAP_SIZE; i0++)
+		for (int j0 = 0; j0 < MOTO_MAP_SIZE; j0++)
+		{
+			int i1 = (i0 + 1) % MOTO_MAP_SIZE;
+			int j1 = (j0 + 1) % MOTO_MAP_SIZE;
+			MotoCell* pCell = &pWorld->Cells[i0][j0];
+			pCell->x00 = pWorld->Map[i0][j0][0];
+			pCell->y00 = pWorld->Map[i0][j0][1];
+			pCell->x01 = pWorld->Map[i0][j1][0];
+			pCell->y01 = pWorld->Map[i0][j1][1];
+			pCell->x10 = pWorld->Map[i1][j0][0];
+			pCell->y10 = pWorld->Map[i1][j0][1];
+			pCell->x11 = pWorld->Map[i1][j1][0];
+			pCell->y11 = pWorld->Map[i1][j1][1];
+			pCell->x1 = pCell->x10 - pCell->x00;
+			pCell->x2 = pCell->x01 - pCell->x00;
+			pCell->x3 = pCell->x00 - pCell->x01 - pCell->x10 + pCell->x11;
+			pCell->y1 = pCell->y10 - pCell->y00;
+			pCell->y2 = pCell->y01 - pCell->y00;
+			pCell->y3 = pCell->y00 - pCell->y01 - pCell->y10 + pCell->y11;
+		}
+}
 
-    int offset = -300;
+/* Same as hashWorldChunk but for MOTO_SHA512_LANES chunks at once. */
+static void hashWorldChunks(MotoWorld* const* pWorlds, uint8_t* const* pBlockPlusNonce, const int* iChunks)
+{
+	uint8_t* pDigests[MOTO_SHA512_LANES];
+	for (int l = 0; l < MOTO_SHA512_LANES; l++)
+	{
+		pBlockPlusNonce[l][0] = iChunks[l];
+		pDigests[l] = ((uint8_t*)pWorlds[l]->Map) + MOTO_MAP_CHUNK_SIZE*iChunks[l];
+	}
+	motoSHA512Batch(pBlockPlusNonce, MOTO_WORK_SIZE + 1 + sizeof(uint32_t), pDigests);
+}
 
-    while(t!=true){
-        if(n%100000==0){DEBUG_MSG("n: "<<n);}
-        n++;
-        i=0;score=0;
-        pow->Nonce++;
-        memcpy(BlockPlusNonce + 1, &(pow->Nonce), sizeof(uint32_t));
+bool motoGenerateRandomWorld(MotoWorld* pWorld, MotoState* pState, const uint8_t* pWork, MotoPoW* pow)
+{
+    const int max_t=18;
+    int max_score=0,i,n=0;
+
+    /* Nonces are tried in groups, one nonce per SHA-512 lane. */
+    MotoWorld Worlds[MOTO_SHA512_LANES];
+    MotoWorld* pWorlds[MOTO_SHA512_LANES];
+    uint8_t BlockPlusNonce[MOTO_SHA512_LANES][MOTO_WORK_SIZE + 1 + sizeof(uint32_t)];
+    uint8_t* pBlockPlusNonce[MOTO_SHA512_LANES];
+    for (int l = 0; l < MOTO_SHA512_LANES; l++)
+    {
+        pWorlds[l] = &Worlds[l];
+        pBlockPlusNonce[l] = BlockPlusNonce[l];
+        memcpy(BlockPlusNonce[l] + 1 + sizeof(uint32_t), pWork, MOTO_WORK_SIZE);
+    }
+
+    int offset = -300;
 
-        SHA512(BlockPlusNonce, MOTO_WORK_SIZE + 1 + sizeof(uint32_t), ((uint8_t*)pWorld->Map) +  512/8*7);
+    /* Sample points on the line from finish to start and chunks that they need. Every point must be in the sky. */
+    int32_t P[max_t + 1][2];
+    int Chunks[max_t + 1][2];
+    for(i=0;i<=max_t;i++){
+        P[i][0]=(g_MotoFinishL[0]/max_t*(max_t-i)+g_MotoStartL[0]/max_t*(i));
+        P[i][1]=((g_MotoFinishL[1])/max_t*(max_t-i)+g_MotoStartL[1]/max_t*(i));
+        int i0 = ((uint32_t)(P[i][0])*(int64_t)(MOTO_MAP_SIZE)) >> 32;
+        Chunks[i][0] = i0/2;
+        Chunks[i][1] = ((i0 + 1) % MOTO_MAP_SIZE)/2;
+    }
 
+    /* Chunks needed by the first point are hashed for all lanes at once. */
+    int NumFirstChunks = (Chunks[0][0] == Chunks[0][1]) ? 1 : 2;
+    unsigned int FirstHashed = (1 << Chunks[0][0]) | (1 << Chunks[0][1]);
 
-        for (i = 0; i < 2*MOTO_MAP_SIZE*MOTO_MAP_SIZE/(512/8); i++)
+    while(true){
+        for (int l = 0; l < MOTO_SHA512_LANES; l++)
+        {
+            uint32_t Nonce = pow->Nonce + 1 + l;
+            memcpy(BlockPlusNonce[l] + 1, &Nonce, sizeof(uint32_t));
+        }
+        for (int k = 0; k < NumFirstChunks; k++)
         {
-            BlockPlusNonce[0] = i;
-            SHA512(BlockPlusNonce, MOTO_WORK_SIZE + 1 + sizeof(uint32_t), ((uint8_t*)pWorld->Map) +  512/8*i);
-//            if(i<7&&i>1&&(pWorld->Map[i*2][5][0]<0||pWorld->Map[i*2][6][0]>0||
-//                   pWorld->Map[i*2+1][5][0]<0||pWorld->Map[i*2+1][6][0]>0)){
-//                break;
-//            }
+            int iChunks[MOTO_SHA512_LANES];
+            for (int l = 0; l < MOTO_SHA512_LANES; l++)
+                iChunks[l] = Chunks[0][k];
+            hashWorldChunks(pWorlds, pBlockPlusNonce, iChunks);
         }
 
-        for(i=0;i<=max_t;i++){
-            P[0]=(g_MotoFinishL[0]/max_t*(max_t-i)+g_MotoStartL[0]/max_t*(i));
-            P[1]=((g_MotoFinishL[1])/max_t*(max_t-i)+g_MotoStartL[1]/max_t*(i));
-            if(getF(pWorld,P)<-offset){
-                score++;
+        int l;
+        for (l = 0; l < MOTO_SHA512_LANES; l++)
+        {
+            if(n%100000==0){DEBUG_MSG("n: "<<n);}
+            n++;
+
+            /* Hash only chunks that are needed by the next point, most nonces are rejected by first few points. */
+            unsigned int Hashed = FirstHashed;
+            for(i=0;i<=max_t;i++){
+                for (int k = 0; k < 2; k++)
+                    if (!(Hashed & (1 << Chunks[i][k])))
+                    {
+                        hashWorldChunk(&Worlds[l], BlockPlusNonce[l], Chunks[i][k]);
+                        Hashed |= 1 << Chunks[i][k];
+                    }
+                if(getF(&Worlds[l],P[i])>=-offset){
+                    break;
+                }
+            }
+            if(i>max_score){
+                max_score=i;
+                DEBUG_MSG("score: "<<i);
+                DEBUG_MSG("nonce: "<<pow->Nonce + 1 + l);
+            }
+            if(i>max_t){
+                for (int k = 0; k < MOTO_MAP_NUM_CHUNKS; k++)
+                    if (!(Hashed & (1 << k)))
+                        hashWorldChunk(&Worlds[l], BlockPlusNonce[l], k);
+                break;
             }
         }
-//        if(i>max_i){
-//            max_i=i;
-//            cout<<"i: "<<i<<endl;
-//            cout<<"n: "<<pow->Nonce<<endl;
-//        }
-        if(score>max_score){
-            max_score=score;
-            DEBUG_MSG("score: "<<score);
-            DEBUG_MSG("nonce: "<<pow->Nonce);
+
+        if (l < MOTO_SHA512_LANES)
+        {
+            pow->Nonce += 1 + l;
+            *pWorld = Worlds[l];
+            break;
         }
-        if(score>max_t){break;}
+        pow->Nonce += MOTO_SHA512_LANES;
     }
 	for (int i = 0; i < MOTO_MAP_SIZE; i++)
 	{
@@ -624,6 +708,7 @@ bool motoGenerateRandomWorld(MotoWorld* pWorld, MotoState* pState, const uint8_t
 		//pWorld->Map[i][MOTO_MAP_SIZE-1][0] = 0;
 		//pWorld->Map[i][MOTO_MAP_SIZE-1][1] = -127;
 	}
+	buildCells(pWorld);
 
 	memset(pState, 0, sizeof(MotoState));
 	pState->iLastRotate = -10000;
@@ -688,16 +773,23 @@ bool motoGenerateGoodWorld(MotoWorld* pWorld, MotoState* pState, const uint8_t*
 
 bool motoGenerateWorld(MotoWorld* pWorld, MotoState* pState, const uint8_t* pWork, uint32_t Nonce)
 {
-initTables();
-
-uint8_t BlockPlusNonce[MOTO_WORK_SIZE + 1 + sizeof(uint32_t)];
-memcpy(BlockPlusNonce + 1, &Nonce, sizeof(uint32_t));
-memcpy(BlockPlusNonce + 1 + sizeof(uint32_t), pWork, MOTO_WORK_SIZE);
+uint8_t BlockPlusNonce[MOTO_SHA512_LANES][MOTO_WORK_SIZE + 1 + sizeof(uint32_t)];
+uint8_t* pBlockPlusNonce[MOTO_SHA512_LANES];
+MotoWorld* pWorlds[MOTO_SHA512_LANES];
+for (int l = 0; l < MOTO_SHA512_LANES; l++)
+{
+memcpy(BlockPlusNonce[l] + 1, &Nonce, sizeof(uint32_t));
+memcpy(BlockPlusNonce[l] + 1 + sizeof(uint32_t), pWork, MOTO_WORK_SIZE);
+pBlockPlusNonce[l] = BlockPlusNonce[l];
+pWorlds[l] = pWorld;
+}
 
-for (int i = 0; i < 2*MOTO_MAP_SIZE*MOTO_MAP_SIZE/(512/8); i++)
+for (int i = 0; i < MOTO_MAP_NUM_CHUNKS; i += MOTO_SHA512_LANES)
 {
-BlockPlusNonce[0] = i;
-        SHA512(BlockPlusNonce, MOTO_WORK_SIZE + 1 + sizeof(uint32_t), ((uint8_t*)pWorld->Map) + 512/8*i);
+int iChunks[MOTO_SHA512_LANES];
+for (int l = 0; l < MOTO_SHA512_LANES; l++)
+iChunks[l] = i + l;
+hashWorldChunks(pWorlds, pBlockPlusNonce, iChunks);
 }
 for (int i = 0; i < MOTO_MAP_SIZE; i++)
 {
@@ -706,6 +798,7 @@ pWorld->Map[i][0][1] = 127;
 //pWorld->Map[i][MOTO_MAP_SIZE-1][0] = 0;
 //pWorld->Map[i][MOTO_MAP_SIZE-1][1] = -127;
 }
+buildCells(pWorld);
 
 memset(pState, 0, sizeof(MotoState));
 pState->iLastRotate = -10000;
@@ -734,9 +827,39 @@ bool motoCheck(const uint8_t* pWork, MotoPoW* pPoW)
 	return motoReplay(&State, pPoW, &World, MOTO_MAX_FRAMES + 10);
 }
 
-bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame)
+/* Bike doesn't move faster than rim of powered wheel at g_MaxSpeed (in practice it stays below 0.6 of this). */
+#define g_MaxBikeStep ((int64_t)g_MaxSpeed*g_MotoWheelR_div_PosK/g_InvAngPosK)
+
+/* Bike is never that far from its wheels and head, so success is impossible if bike is farther than that from finish. */
+#define g_MaxSuccessDist (3*(int64_t)g_WheelDist + g_2WheelR_div_PosK)
+
+/* Check if bike can't get closer to finish than BoundDistSq (as measured by distSqp) in remaining frames.
+   Uses maximum speed of the bike, so it is only suitable for search, not for validation.
+   pMinDistSq (out) - Lower bound of distSqp at the end, set only if true is returned. */
+static bool isHopeless(const MotoState* pState, int16_t iLastFrame, int64_t BoundDistSq, int64_t* pMinDistSq)
+{
+	/* Nothing to check while bike can still get anywhere, it is most of the time. */
+	int64_t Travel = (iLastFrame - pState->iFrame)*g_MaxBikeStep >> 4;
+	if (Travel >= (((int64_t)1) << 28))
+		return false;
+
+	/* Distance on torus is not larger than distSqp, both coordinates are scaled down by 16 to avoid overflow. */
+	int64_t dx = (int32_t)(pState->Bike.Pos[0] - g_MotoFinish[0]) >> 4;
+	int64_t dy = (int32_t)(pState->Bike.Pos[1] - g_MotoFinish[1]) >> 4;
+	int64_t Reach = (int64_t)isqrt(dx*dx + dy*dy) - 1 - Travel;
+	if (Reach <= (g_MaxSuccessDist >> 4))
+		return false;
+	int64_t MinDistSq = (Reach*Reach) >> 27;
+	if (MinDistSq < BoundDistSq)
+		return false;
+	*pMinDistSq = MinDistSq;
+	return true;
+}
+
+static bool replay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pCheckpoints, int* pNumCheckpoints, MotoState* pTrace, int64_t BoundDistSq)
 {
 	int16_t iFrame = 0;
+	int16_t iLastFrame = min(iToFrame, (int16_t)pPoW->NumFrames);
 	EMotoAccel Accel = MOTO_IDLE;
 	EMotoRot Rotation = MOTO_NO_ROTATION;
 	for (unsigned int i = 0; i <= pPoW->NumUpdates; i++)
@@ -761,6 +884,8 @@ bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16
 		while (pState->iFrame < iFrame)
 		{
             pState->curState=advanceOneFrame(pState, Accel, Rotation, pWorld);
+			if (pTrace)
+				pTrace[pState->iFrame] = *pState;
             switch (pState->curState)
 			{
             case MOTO_CONTINUE:
@@ -783,6 +908,17 @@ bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16
 //                cout << "(pState->iFrame >= iToFrame)" <<endl;
 				return false;
             }
+
+			/* Give up if candidate can't beat the bound. */
+			if (BoundDistSq > 0 && pState->iFrame % 16 == 0 && isHopeless(pState, iLastFrame, BoundDistSq, &pState->finishDistSq))
+				return false;
+		}
+
+		/* Save state before update is applied. States of skipped updates are left as is. */
+		if (pCheckpoints && i < pPoW->NumUpdates && pState->iFrame == iFrame)
+		{
+			pCheckpoints[i] = *pState;
+			*pNumCheckpoints = i + 1;
 		}
 
 		Accel = (EMotoAccel)(pPoW->Updates[i] % 4);
@@ -792,6 +928,89 @@ bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16
 	return false;
 }
 
+bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame)
+{
+	return replay(pState, pPoW, pWorld, iToFrame, NULL, NULL, NULL, 0);
+}
+
+bool motoReplayWithCheckpoints(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pCheckpoints, int* pNumCheckpoints)
+{
+	return replay(pState, pPoW, pWorld, iToFrame, pCheckpoints, pNumCheckpoints, NULL, 0);
+}
+
+bool motoReplayBounded(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pCheckpoints, int* pNumCheckpoints, int64_t BoundDistSq)
+{
+	return replay(pState, pPoW, pWorld, iToFrame, pCheckpoints, pNumCheckpoints, NULL, BoundDistSq);
+}
+
+bool motoReplayWithTrace(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pTrace)
+{
+	return replay(pState, pPoW, pWorld, iToFrame, NULL, NULL, pTrace, 0);
+}
+
+/* Number of leading input updates that are the same. */
+static int countCommonUpdates(const MotoPoW* pA, const MotoPoW* pB)
+{
+	int NumUpdates = min(pA->NumUpdates, pB->NumUpdates);
+	int i = 0;
+	while (i < NumUpdates && pA->Updates[i] == pB->Updates[i])
+		i++;
+	return i;
+}
+
+void motoReplayBatch(MotoState* pStates, MotoPoW* pPoWs, bool* pResults, int NumCandidates, const MotoWorld* pWorld, int16_t iToFrame)
+{
+	/* Replay candidates in order of their input, so that neighbours have the longest common beginning. */
+	vector<int> Order(NumCandidates);
+	for (int c = 0; c < NumCandidates; c++)
+		Order[c] = c;
+	sort(Order.begin(), Order.end(), [&](int a, int b)
+	{
+		int Cmp = memcmp(&pStates[a], &pStates[b], sizeof(MotoState));
+		if (Cmp != 0)
+			return Cmp < 0;
+		if (pPoWs[a].NumFrames != pPoWs[b].NumFrames)
+			return pPoWs[a].NumFrames < pPoWs[b].NumFrames;
+		int i = countCommonUpdates(&pPoWs[a], &pPoWs[b]);
+		if (i < pPoWs[a].NumUpdates && i < pPoWs[b].NumUpdates)
+			return pPoWs[a].Updates[i] < pPoWs[b].Updates[i];
+		return pPoWs[a].NumUpdates < pPoWs[b].NumUpdates;
+	});
+
+	/* States at each input update of previous candidate and of current one. */
+	MotoState Checkpoints[2][MOTO_MAX_INPUTS];
+	int NumCheckpoints[2] = { 0, 0 };
+	int iPrev = 0;
+	MotoState PrevFirstFrame;
+	MotoPoW PrevPoW;
+	for (int k = 0; k < NumCandidates; k++)
+	{
+		int c = Order[k];
+		MotoState FirstFrame = pStates[c];
+		MotoPoW PoW = pPoWs[c];
+		MotoState* pCheckpoints = Checkpoints[1 - iPrev];
+		int* pNumCheckpoints = &NumCheckpoints[1 - iPrev];
+
+		/* Checkpoint i of previous candidate is valid if it started from the same state and updates up to i (inclusive) are the same. */
+		int i = -1;
+		if (k > 0 && PoW.NumFrames == PrevPoW.NumFrames && memcmp(&FirstFrame, &PrevFirstFrame, sizeof(MotoState)) == 0)
+			i = min(countCommonUpdates(&PoW, &PrevPoW), NumCheckpoints[iPrev]) - 1;
+
+		*pNumCheckpoints = 0;
+		if (i >= 0)
+		{
+			memcpy(pCheckpoints, Checkpoints[iPrev], i*sizeof(MotoState));
+			pStates[c] = Checkpoints[iPrev][i];
+			*pNumCheckpoints = i;
+		}
+		pResults[c] = replay(&pStates[c], &pPoWs[c], pWorld, iToFrame, pCheckpoints, pNumCheckpoints, NULL, 0);
+
+		PrevFirstFrame = FirstFrame;
+		PrevPoW = PoW;
+		iPrev = 1 - iPrev;
+	}
+}
+
 void motoCutPoW(MotoPoW* pPoW, int16_t iToFrame)
 {
 	pPoW->NumFrames = iToFrame;
@@ -808,6 +1027,35 @@ void motoCutPoW(MotoPoW* pPoW, int16_t iToFrame)
 	}
 }
 
+bool motoIsValidInput(const MotoPoW* pPoW)
+{
+	if (pPoW->NumUpdates > MOTO_MAX_INPUTS)
+		return false;
+
+	int iFrame = 0;
+	int iLastRotate = -g_RotationPeriod;
+	EMotoAccel Accel = MOTO_IDLE;
+	for (unsigned int i = 0; i < pPoW->NumUpdates; i++)
+	{
+		int iFrameDelta = pPoW->Updates[i] / 12;
+		EMotoAccel NewAccel = (EMotoAccel)(pPoW->Updates[i] % 4);
+		EMotoRot NewRotation = (EMotoRot)((pPoW->Updates[i] % 12) / 4);
+		iFrame += iFrameDelta;
+		if ((i != 0 && iFrameDelta == 0) || iFrame >= pPoW->NumFrames)
+			return false;
+		if (iFrameDelta != 5460 && NewAccel == Accel && NewRotation == MOTO_NO_ROTATION)
+			return false;
+		if (NewRotation != MOTO_NO_ROTATION)
+		{
+			if (iFrame - iLastRotate < g_RotationPeriod)
+				return false;
+			iLastRotate = iFrame;
+		}
+		Accel = NewAccel;
+	}
+	return true;
+}
+
 void motoInitPoW(MotoPoW* pPoW)
 {
 	memset(pPoW, 0, sizeof(MotoPoW));
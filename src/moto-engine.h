@@ -88,12 +88,36 @@ typedef enum
 	MOTO_ROTATE_CCW, /**< Player is currently rotating counter-clockwise. */
 } EMotoRot;
 
+#if defined(_MSC_VER)
+    #define MOTO_CACHE_ALIGNED __declspec(align(64))
+#elif defined(__GNUC__)
+    #define MOTO_CACHE_ALIGNED __attribute__((aligned(64)))
+#else
+    #define MOTO_CACHE_ALIGNED
+#endif
+
+/** \brief Perlin-noise coefficients of one grid cell.
+*
+* Gradients in four corners of the cell and their combinations that don't depend on position inside of the cell.
+* Derived from MotoWorld::Map, so that field evaluation doesn't have to gather and widen them again and again.
+* Exactly one cache line.
+*/
+typedef struct
+{
+	int32_t x00, y00, x01, y01, x10, y10, x11, y11; /**< Gradients in corners. */
+	int32_t x1, x2, x3, y1, y2, y3;                 /**< x10 - x00, x01 - x00, x00 - x01 - x10 + x11 and same for y. */
+	int32_t Padding[2];
+} MotoCell;
+
 /** \brief Pseudo-randomly generated world.
 *
 * Contains no state.
 */
 typedef struct
 {
+	/** Coefficients of each cell, built from Map when world is generated. */
+	MOTO_CACHE_ALIGNED MotoCell Cells[MOTO_MAP_SIZE][MOTO_MAP_SIZE];
+
 	/** Values for Perlin-noise. */
 	int8_t Map[MOTO_MAP_SIZE][MOTO_MAP_SIZE][2];
 } MotoWorld;
@@ -206,10 +230,64 @@ EMotoResult motoAdvance(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorl
 
 bool motoReplay(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame);
 
+/** \brief Replay player input and save intermediate states.
+*
+* Same as motoReplay, but also saves state at the frame of each input update (before update is applied).
+* Replay may be resumed from any saved state: copy pCheckpoints[i] to pState and set *pNumCheckpoints to i,
+* then result will be the same as if whole input was replayed from the beginning.
+* Input updates before i must be the same as when checkpoint was saved, as well as frame of update i.
+*
+* @param pCheckpoints (out) - Array of MOTO_MAX_INPUTS states.
+* @param pNumCheckpoints (in/out) - Number of valid checkpoints.
+*/
+bool motoReplayWithCheckpoints(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pCheckpoints, int* pNumCheckpoints);
+
+/** \brief Replay player input of search candidate, give up when it can't finish closer than the best one.
+*
+* Same as motoReplayWithCheckpoints, but periodically checks how close bike can get to finish in remaining frames.
+* If it can't get closer than BoundDistSq, replay is stopped and finishDistSq of pState is set to lower bound
+* of its final value, which is not less than BoundDistSq. Other fields of pState are state at that frame.
+* Bound is based on maximum speed of the bike, so this is for search only, use motoReplay for validation.
+*
+* @param pCheckpoints (out) - Array of MOTO_MAX_INPUTS states, may be NULL.
+* @param BoundDistSq - finishDistSq of the best candidate so far, 0 disables the check.
+*/
+bool motoReplayBounded(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pCheckpoints, int* pNumCheckpoints, int64_t BoundDistSq);
+
+/** \brief Replay player input and save state after each frame.
+*
+* Same as motoReplay, but also saves state after each simulated frame. Used to compare engine
+* implementations frame by frame, too slow for anything else.
+*
+* @param pTrace (out) - Array of MOTO_MAX_FRAMES + 1 states, state after frame i is stored at index i.
+*/
+bool motoReplayWithTrace(MotoState* pState, MotoPoW* pPoW, const MotoWorld* pWorld, int16_t iToFrame, MotoState* pTrace);
+
+/** \brief Replay input of several candidates in the same world.
+*
+* Result is exactly the same as calling motoReplay for each candidate, but frames
+* before the first difference in input of candidates that start from the same state are simulated once.
+* Candidates that were derived from the same input (e.g. during search) are replayed much faster.
+*
+* @param pStates (in/out) - NumCandidates initial states, final states are stored here.
+* @param pPoWs (in/out) - NumCandidates player inputs, modified the same way as by motoReplay.
+* @param pResults (out) - NumCandidates values that motoReplay would return.
+*/
+void motoReplayBatch(MotoState* pStates, MotoPoW* pPoWs, bool* pResults, int NumCandidates, const MotoWorld* pWorld, int16_t iToFrame);
+
 bool recordInput(MotoPoW* pPoW, MotoState* pState, EMotoAccel Accel, EMotoRot Rotation);
 
 void motoF(float Fdxdy[3], float x, float y, const MotoWorld* pWorld);
 
 void motoCutPoW(MotoPoW* pPoW, int16_t iToFrame);
 
+/** \brief Check player input without simulation.
+*
+* Input is valid if motoReplay can't reject it because of the input itself: there are at most MOTO_MAX_INPUTS
+* updates, all of them are before NumFrames, each one changes something (except 5460 frame gaps)
+* and rotations are at least g_RotationPeriod frames apart. It is a bit stricter than motoReplay,
+* because several updates at the same frame are not allowed.
+*/
+bool motoIsValidInput(const MotoPoW* pPoW);
+
 #endif /* MOTOCOIN_MOTOENGINE_H */
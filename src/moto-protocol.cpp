@@ -9,6 +9,8 @@
 // Currently all communication is done over stdio.
 //--------------------------------------------------------------------
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include "moto-protocol.h"
@@ -17,6 +19,20 @@ using namespace std;
 
 static const char* g_pMsgWork = "***Work:";
 static const char* g_pMsgWorkAndPoW = "***WPoW:";
+static const char* g_pMsgHello = "***Bin:";
+
+// Frame header: magic, version, type, zero, job ID, size of payload. Integers are little-endian.
+// Magic can't start a text line, so frames and lines may be mixed in one stream.
+static const uint8_t g_FrameMagic = 0xFB;
+static const size_t g_FrameHeaderSize = 12;
+static const uint32_t g_MaxFrameSize = 4096;
+
+enum
+{
+	FRAME_WORK = 1,
+	FRAME_SOLUTION = 2,
+	FRAME_CANCEL = 3
+};
 
 template<typename T>
 inline string toHexString(const T& Object)
@@ -28,11 +44,11 @@ inline string toHexString(const T& Object)
 	};
 	ObjectData = Object;
 
-	string HexString;
+	string HexString(2*sizeof(T), '0');
 	for (unsigned int i = 0; i < sizeof(T); i++)
 	{
-		HexString += "0123456789abcdef"[Data[i] / 16];
-		HexString += "0123456789abcdef"[Data[i] % 16];
+		HexString[2*i] = "0123456789abcdef"[Data[i] / 16];
+		HexString[2*i + 1] = "0123456789abcdef"[Data[i] % 16];
 	}
 	return HexString;
 }
@@ -91,9 +107,153 @@ bool motoParseMessage(const char* pMsg, MotoWork& Work)
 
 bool motoParseMessage(const char* pMsg, MotoWork& Work, MotoPoW& PoW)
 {
-	if (strncmp(pMsg, g_pMsgWorkAndPoW, strlen(g_pMsgWork)) != 0)
+	if (strncmp(pMsg, g_pMsgWorkAndPoW, strlen(g_pMsgWorkAndPoW)) != 0)
 		return false;
 
 	pMsg += strlen(g_pMsgWorkAndPoW);
 	return readObject(pMsg, Work) && readObject(pMsg, PoW);
 }
+
+string motoHelloMessage(int Version)
+{
+	return string("\n") + g_pMsgHello + to_string(Version) + "\n";
+}
+
+static void putU32(char* pData, uint32_t Value)
+{
+	for (int i = 0; i < 4; i++)
+		pData[i] = (char)(Value >> 8*i);
+}
+
+static uint32_t getU32(const char* pData)
+{
+	uint32_t Value = 0;
+	for (int i = 0; i < 4; i++)
+		Value |= (uint32_t)(uint8_t)pData[i] << 8*i;
+	return Value;
+}
+
+static string makeFrame(uint8_t Type, uint32_t JobId, const void* pPayload, uint32_t Size)
+{
+	string Frame(g_FrameHeaderSize + Size, '\0');
+	Frame[0] = (char)g_FrameMagic;
+	Frame[1] = MOTO_FRAME_VERSION;
+	Frame[2] = (char)Type;
+	putU32(&Frame[4], JobId);
+	putU32(&Frame[8], Size);
+	if (Size > 0)
+		memcpy(&Frame[g_FrameHeaderSize], pPayload, Size);
+	return Frame;
+}
+
+string motoFrame(uint32_t JobId, const MotoWork& Work)
+{
+	return makeFrame(FRAME_WORK, JobId, &Work, sizeof(Work));
+}
+
+string motoFrame(uint32_t JobId, const MotoPoW& PoW)
+{
+	return makeFrame(FRAME_SOLUTION, JobId, &PoW, sizeof(PoW));
+}
+
+string motoCancelFrame(uint32_t JobId)
+{
+	return makeFrame(FRAME_CANCEL, JobId, NULL, 0);
+}
+
+void CMotoReader::append(const char* pData, size_t Size)
+{
+	// Drop consumed data only when it is the most of buffer, so that data is not moved on each message.
+	if (m_Pos > 0 && m_Pos >= m_Buffer.size()/2)
+	{
+		m_Buffer.erase(0, m_Pos);
+		m_Pos = 0;
+	}
+	m_Buffer.append(pData, Size);
+}
+
+bool CMotoReader::next(MotoMessage& Msg)
+{
+	while (m_Pos < m_Buffer.size())
+	{
+		const char* pData = m_Buffer.data() + m_Pos;
+		size_t Available = m_Buffer.size() - m_Pos;
+
+		if ((uint8_t)pData[0] == g_FrameMagic)
+		{
+			if (Available < g_FrameHeaderSize)
+				return false;
+			uint32_t Size = getU32(pData + 8);
+			if (Size > g_MaxFrameSize)
+			{
+				// Not a frame, skip garbage byte.
+				m_Pos++;
+				continue;
+			}
+			if (Available < g_FrameHeaderSize + Size)
+				return false;
+			m_Pos += g_FrameHeaderSize + Size;
+
+			// Frames of other versions and unknown frames are skipped.
+			if (pData[1] != MOTO_FRAME_VERSION)
+				continue;
+			const char* pPayload = pData + g_FrameHeaderSize;
+			Msg.JobId = getU32(pData + 4);
+			switch (pData[2])
+			{
+			case FRAME_WORK:
+				if (Size != sizeof(MotoWork))
+					continue;
+				Msg.Type = MOTO_MSG_WORK;
+				memcpy(&Msg.Work, pPayload, Size);
+				return true;
+			case FRAME_SOLUTION:
+				if (Size != sizeof(MotoPoW))
+					continue;
+				Msg.Type = MOTO_MSG_SOLUTION;
+				memcpy(&Msg.PoW, pPayload, Size);
+				return true;
+			case FRAME_CANCEL:
+				Msg.Type = MOTO_MSG_CANCEL;
+				return true;
+			default:
+				continue;
+			}
+		}
+
+		// Lines are limited like frames, so that other side can't make us buffer endless line.
+		const char* pEnd = (const char*)memchr(pData, '\n', min(Available, (size_t)g_MaxFrameSize + 1));
+		if (!pEnd)
+		{
+			if (Available <= g_MaxFrameSize)
+				return false;
+			m_Overflow = true;
+			m_Pos = m_Buffer.size();
+			return false;
+		}
+		m_Pos += pEnd - pData + 1;
+		string Line(pData, pEnd);
+		if (!Line.empty() && Line[Line.size() - 1] == '\r')
+			Line.resize(Line.size() - 1);
+		if (Line.empty())
+			continue;
+
+		Msg.JobId = 0;
+		if (strncmp(Line.c_str(), g_pMsgHello, strlen(g_pMsgHello)) == 0)
+		{
+			Msg.Type = MOTO_MSG_HELLO;
+			Msg.Version = atoi(Line.c_str() + strlen(g_pMsgHello));
+		}
+		else if (motoParseMessage(Line.c_str(), Msg.Work))
+			Msg.Type = MOTO_MSG_WORK;
+		else if (motoParseMessage(Line.c_str(), Msg.Work, Msg.PoW))
+			Msg.Type = MOTO_MSG_WORK_POW;
+		else
+		{
+			Msg.Type = MOTO_MSG_TEXT;
+			Msg.Text = move(Line);
+		}
+		return true;
+	}
+	return false;
+}
@@ -7,18 +7,79 @@
 //--------------------------------------------------------------------
 // Protocol for communication between Motocoin-Qt and motogame.
 // Currently all communication is done over stdio.
+//
+// By default messages are lines with hex encoded structures. Motocoin-Qt
+// offers binary framing with hello line, if other side answers with the
+// same line both sides switch to length-prefixed binary frames that carry
+// job ID. Reader accepts both kinds of messages at any time, so there is
+// no need to synchronize the switch.
 //--------------------------------------------------------------------
 
 #ifndef MOTOCOIN_MOTOPROTOCOL_H
 #define MOTOCOIN_MOTOPROTOCOL_H
 
 #include <string>
+#include <stdint.h>
 #include "moto-engine.h"
 
+/** Version of binary framing that we support. */
+#define MOTO_FRAME_VERSION 1
+
+/** Hex lines, they start with newline too: the other side may print debug output to the same
+* stdout without newline at the end, and the message must start on its own line to be recognized. */
 std::string motoMessage(const MotoWork& Work);
 std::string motoMessage(const MotoWork& Work, const MotoPoW& PoW);
 
 bool motoParseMessage(const char* pMsg, MotoWork& Work);
 bool motoParseMessage(const char* pMsg, MotoWork& Work,  MotoPoW& PoW);
 
-#endif // MOTOCOIN_MOTOPROTOCOL_H
\ No newline at end of file
+/** Offer (or accept) binary framing of given version. It is a hex-style line, so it starts with newline as well. */
+std::string motoHelloMessage(int Version = MOTO_FRAME_VERSION);
+
+/** Binary frames, must be sent only after hello was answered. Job ID must not be zero. */
+std::string motoFrame(uint32_t JobId, const MotoWork& Work);
+std::string motoFrame(uint32_t JobId, const MotoPoW& PoW); /**< Solution of the job. */
+std::string motoCancelFrame(uint32_t JobId); /**< From Motocoin-Qt: job is useless, from motogame: job is abandoned. */
+
+typedef enum
+{
+	MOTO_MSG_TEXT,     /**< Any other line, e.g. error message. */
+	MOTO_MSG_HELLO,
+	MOTO_MSG_WORK,
+	MOTO_MSG_WORK_POW, /**< Hex line with solution, it carries whole work instead of job ID. */
+	MOTO_MSG_SOLUTION,
+	MOTO_MSG_CANCEL
+} EMotoMsg;
+
+/** Message read from stream. Only fields of its type are set. */
+struct MotoMessage
+{
+	EMotoMsg Type;
+	uint32_t JobId;    /**< Zero for hex lines. */
+	int Version;       /**< For MOTO_MSG_HELLO. */
+	MotoWork Work;
+	MotoPoW PoW;
+	std::string Text;
+};
+
+/** Splits stream into messages. Data may be appended in chunks of any size. */
+class CMotoReader
+{
+public:
+	CMotoReader() : m_Pos(0), m_Overflow(false) {}
+
+	void append(const char* pData, size_t Size);
+
+	/** Next complete message, returns false if more data is needed. */
+	bool next(MotoMessage& Msg);
+
+	/** Line longer than any message was received and dropped, other side is not to be trusted. */
+	bool hasOverflowed() const { return m_Overflow; }
+
+private:
+	std::string m_Buffer;
+	size_t m_Pos;
+	bool m_Overflow;
+};
+
+#endif // MOTOCOIN_MOTOPROTOCOL_H
@@ -0,0 +1,184 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin, Motocoin-Qt and motocoind.
+//--------------------------------------------------------------------
+// Multi-buffer SHA-512 used for world generation.
+// World is generated from many short messages of the same length,
+// each of them fits into single SHA-512 block, so we compress
+// several blocks at once, one message per SIMD lane.
+//--------------------------------------------------------------------
+
+#include <string.h>
+
+#include "moto-sha512.h"
+
+#if defined(__GNUC__)
+    #define MOTO_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+    #define MOTO_FORCE_INLINE __forceinline
+#else
+    #define MOTO_FORCE_INLINE inline
+#endif
+
+static const uint64_t g_SHA512K[80] =
+{
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static const uint64_t g_SHA512H[8] =
+{
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+/*
+SHA-512 compression of one block, state is initial hash value.
+T is either uint64_t (one message) or vector of uint64_t (one message per lane).
+*/
+template<typename T>
+static MOTO_FORCE_INLINE void compress(T H[8], T W[16])
+{
+	T a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
+	for (int i = 0; i < 80; i++)
+	{
+		if (i >= 16)
+		{
+			T w15 = W[(i - 15) & 15];
+			T w2 = W[(i - 2) & 15];
+			T s0 = ROTR(w15, 1) ^ ROTR(w15, 8) ^ (w15 >> 7);
+			T s1 = ROTR(w2, 19) ^ ROTR(w2, 61) ^ (w2 >> 6);
+			W[i & 15] += s0 + W[(i - 7) & 15] + s1;
+		}
+
+		T t1 = h + (ROTR(e, 14) ^ ROTR(e, 18) ^ ROTR(e, 41)) + ((e & f) ^ (~e & g)) + g_SHA512K[i] + W[i & 15];
+		T t2 = (ROTR(a, 28) ^ ROTR(a, 34) ^ ROTR(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+}
+
+/* Load padded message as big-endian words. */
+static void loadBlock(uint64_t W[16], const uint8_t* pMsg, size_t Len)
+{
+	uint8_t Block[128];
+	memset(Block, 0, sizeof(Block));
+	memcpy(Block, pMsg, Len);
+	Block[Len] = 0x80;
+	uint64_t Bits = (uint64_t)Len*8;
+	for (int i = 0; i < 8; i++)
+		Block[127 - i] = (uint8_t)(Bits >> (8*i));
+
+	for (int i = 0; i < 16; i++)
+	{
+		W[i] = 0;
+		for (int j = 0; j < 8; j++)
+			W[i] = (W[i] << 8) | Block[8*i + j];
+	}
+}
+
+static void storeDigest(uint8_t* pDigest, const uint64_t H[8])
+{
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 8; j++)
+			pDigest[8*i + j] = (uint8_t)(H[i] >> (56 - 8*j));
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MOTO_SHA512_SIMD
+
+typedef uint64_t u64xN __attribute__((vector_size(8*MOTO_SHA512_LANES)));
+
+/* Same code compiled twice: with AVX2 and with baseline instruction set (SSE2 on x86-64). */
+__attribute__((target("avx2"))) static void compressAVX2(u64xN H[8], u64xN W[16])
+{
+	compress(H, W);
+}
+
+static void compressBaseline(u64xN H[8], u64xN W[16])
+{
+	compress(H, W);
+}
+
+static void hashSIMD(const uint8_t* const* pMsgs, size_t Len, uint8_t* const* pDigests, bool AVX2)
+{
+	u64xN W[16];
+	u64xN H[8];
+	for (int l = 0; l < MOTO_SHA512_LANES; l++)
+	{
+		uint64_t LaneW[16];
+		loadBlock(LaneW, pMsgs[l], Len);
+		for (int i = 0; i < 16; i++)
+			W[i][l] = LaneW[i];
+	}
+	for (int i = 0; i < 8; i++)
+		for (int l = 0; l < MOTO_SHA512_LANES; l++)
+			H[i][l] = g_SHA512H[i];
+
+	if (AVX2)
+		compressAVX2(H, W);
+	else
+		compressBaseline(H, W);
+
+	for (int l = 0; l < MOTO_SHA512_LANES; l++)
+	{
+		uint64_t LaneH[8];
+		for (int i = 0; i < 8; i++)
+			LaneH[i] = H[i][l];
+		storeDigest(pDigests[l], LaneH);
+	}
+}
+#else
+static void hashScalar(const uint8_t* const* pMsgs, size_t Len, uint8_t* const* pDigests)
+{
+	for (int l = 0; l < MOTO_SHA512_LANES; l++)
+	{
+		uint64_t W[16];
+		uint64_t H[8];
+		loadBlock(W, pMsgs[l], Len);
+		memcpy(H, g_SHA512H, sizeof(H));
+		compress(H, W);
+		storeDigest(pDigests[l], H);
+	}
+}
+#endif
+
+void motoSHA512Batch(const uint8_t* const* pMsgs, size_t Len, uint8_t* const* pDigests)
+{
+#ifdef MOTO_SHA512_SIMD
+	static const bool AVX2 = __builtin_cpu_supports("avx2");
+	hashSIMD(pMsgs, Len, pDigests, AVX2);
+#else
+	hashScalar(pMsgs, Len, pDigests);
+#endif
+}
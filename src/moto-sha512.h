@@ -0,0 +1,34 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// This file is part of The Game of Motocoin, Motocoin-Qt and motocoind.
+//--------------------------------------------------------------------
+// Multi-buffer SHA-512 used for world generation.
+//--------------------------------------------------------------------
+
+#ifndef MOTOCOIN_MOTOSHA512_H
+#define MOTOCOIN_MOTOSHA512_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of messages hashed by motoSHA512Batch at once. */
+#define MOTO_SHA512_LANES 4
+
+/** Maximum message length that fits into single SHA-512 block. */
+#define MOTO_SHA512_MAX_LEN 111
+
+/** \brief Compute SHA-512 of several messages of the same length at once.
+*
+* Messages are hashed in parallel SIMD lanes (AVX2 or SSE2 if available).
+* Result is the same as computing SHA-512 of each message separately.
+*
+* @param pMsgs (in) - MOTO_SHA512_LANES messages.
+* @param Len - Length of each message, at most MOTO_SHA512_MAX_LEN bytes.
+* @param pDigests (out) - MOTO_SHA512_LANES buffers, 64 bytes each.
+*/
+void motoSHA512Batch(const uint8_t* const* pMsgs, size_t Len, uint8_t* const* pDigests);
+
+#endif /* MOTOCOIN_MOTOSHA512_H */
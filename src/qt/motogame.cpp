@@ -1,6 +1,7 @@
 #include "moto-protocol.h"
 #include "motogame.h"
 #include "main.h"
+#include "livetemplate.h"
 #include <iostream>
 #include <string.h>
 #ifdef _WIN32
@@ -8,6 +9,7 @@
 #endif
 
 static std::unique_ptr<Motogame> g_pMotogame;
+static const int64 g_UpdateInterval = 60; // Seconds, work is reissued with fresh nTime so often even if nothing has changed.
 
 static QString getMotogame(bool LowQ, bool OGL3)
 {
@@ -27,16 +29,21 @@ static QString getMotogame(bool LowQ, bool OGL3)
 }
 
 Motogame::Motogame(bool LowQ, bool OGL3, CWallet* pWallet, QObject *parent) :
-    QObject(parent), m_Motogame(this), m_pWallet(pWallet), m_ReserveKey(pWallet), m_pPrevBest(nullptr)
+    QObject(parent), m_Motogame(this), m_Binary(false), m_NextJobId(1), m_pWallet(pWallet), m_ReserveKey(pWallet), m_pPrevBest(nullptr), m_TemplateVersion(0), m_LastUpdate(0)
 {
     m_Motogame.start(getMotogame(LowQ, OGL3));
 
+    // Offer binary framing, work is sent as hex lines until it is accepted.
+    m_Motogame.write(motoHelloMessage().c_str());
+
     connect(&m_Motogame, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadAvailable()));
     connect(&m_Motogame, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onGameFinished(int, QProcess::ExitStatus)));
     connect(&m_Motogame, SIGNAL(error(QProcess::ProcessError)), this, SLOT(onError(QProcess::ProcessError)));
 
     updateBlock();
-    startTimer(500);
+
+    // Checking live template is cheap, new work is sent soon after it's ready.
+    startTimer(100);
 }
 
 Motogame::~Motogame()
@@ -60,61 +67,100 @@ void Motogame::timerEvent(QTimerEvent*)
     updateBlock();
 }
 
-std::list<std::unique_ptr<CBlockTemplate>>::iterator Motogame::findBlock(const MotoWork& Work)
+std::list<Motogame::Job>::iterator Motogame::findBlock(const MotoWork& Work)
 {
     for (auto iter = m_Templates.begin(); iter != m_Templates.end(); ++iter)
     {
-        if (memcmp(&(*iter)->block.nVersion, Work.Block, MOTO_WORK_SIZE) == 0)
+        if (memcmp(&iter->pTemplate->block.nVersion, Work.Block, MOTO_WORK_SIZE) == 0)
             return iter;
     }
     return m_Templates.end();
 }
 
-void Motogame::onReadAvailable()
+std::list<Motogame::Job>::iterator Motogame::findBlock(unsigned int JobId)
 {
-    while (true)
+    for (auto iter = m_Templates.begin(); iter != m_Templates.end(); ++iter)
     {
-        QByteArray Msg = m_Motogame.readLine();
-        if (Msg.size() == 0)
-            break;
+        if (iter->JobId == JobId)
+            return iter;
+    }
+    return m_Templates.end();
+}
+
+void Motogame::submit(std::list<Job>::iterator iter, const MotoPoW& PoW)
+{
+    if (iter != m_Templates.end())
+    {
+        CBlock *pBlock = &iter->pTemplate->block;
+        pBlock->Nonce = PoW;
+        CheckWork(pBlock, *m_pWallet, m_ReserveKey);
+    }
+    updateBlock();
+}
 
-        MotoWork Work;
-        MotoPoW PoW;
+void Motogame::onReadAvailable()
+{
+    QByteArray Data = m_Motogame.readAll();
+    m_Reader.append(Data.constData(), Data.size());
 
-        if (motoParseMessage(Msg.data(), Work))
+    MotoMessage Msg;
+    while (m_Reader.next(Msg))
+    {
+        switch (Msg.Type)
+        {
+        case MOTO_MSG_HELLO:
+            m_Binary = (Msg.Version == MOTO_FRAME_VERSION);
+            break;
+        case MOTO_MSG_WORK: // Work is abandoned.
+        case MOTO_MSG_CANCEL:
         {
-            auto iter = findBlock(Work);
+            auto iter = Msg.Type == MOTO_MSG_WORK ? findBlock(Msg.Work) : findBlock(Msg.JobId);
             if (iter != m_Templates.end())
                 m_Templates.erase(iter);
+            break;
         }
-        else if (motoParseMessage(Msg.data(), Work, PoW))
-        {
-            auto iter = findBlock(Work);
-            if (iter != m_Templates.end())
-            {
-                CBlock *pBlock = &(*iter)->block;
-                pBlock->Nonce = PoW;
-                CheckWork(pBlock, *m_pWallet, m_ReserveKey);
-            }
-            updateBlock();
-        }else{
-            std::cout<<"moto: "<<std::string(Msg);
+        case MOTO_MSG_WORK_POW:
+            submit(findBlock(Msg.Work), Msg.PoW);
+            break;
+        case MOTO_MSG_SOLUTION:
+            submit(findBlock(Msg.JobId), Msg.PoW);
+            break;
+        case MOTO_MSG_TEXT:
+            std::cout<<"moto: "<<Msg.Text<<"\n";
+            break;
         }
     }
 }
 
 void Motogame::updateBlock()
 {
-    // Create new block.
-    std::unique_ptr<CBlockTemplate> pBlockTemplate(CreateNewBlockWithKey(m_ReserveKey));
+    // Nothing has changed, motogame keeps solving the last work until it gets old.
+    if (m_pPrevBest == pindexBest && !m_Templates.empty() && getLiveTemplateVersion() == m_TemplateVersion &&
+        GetTime() - m_LastUpdate < g_UpdateInterval)
+        return;
+
+    // Copy live template, it's built by node in background.
+    unsigned int Version = 0;
+    std::unique_ptr<CBlockTemplate> pBlockTemplate(getLiveTemplate(m_ReserveKey, false, &Version));
     if (!pBlockTemplate.get())
+    {
+        // Work of previous block is useless, stop motogame even though we have nothing to replace it.
+        if (m_Binary && m_pPrevBest != pindexBest && !m_Templates.empty())
+        {
+            std::string Msg = motoCancelFrame(m_Templates.back().JobId);
+            m_Motogame.write(Msg.data(), Msg.size());
+            m_Templates.clear();
+        }
         return;
+    }
+    m_TemplateVersion = Version;
+    m_LastUpdate = GetTime();
     CBlock *pBlock = &pBlockTemplate->block;
     unsigned int nExtraNonce = 0;
     IncrementExtraNonce(pBlock, pindexBest, nExtraNonce);
 
     // Check if block has changed.
-   /* CBlock *pLastBlock = m_Templates.empty()? nullptr : &m_Templates.back()->block;
+   /* CBlock *pLastBlock = m_Templates.empty()? nullptr : &m_Templates.back().pTemplate->block;
     if (pLastBlock &&
         pBlock->hashPrevBlock == pLastBlock->hashPrevBlock &&
         pBlock->hashMerkleRoot == pLastBlock->hashMerkleRoot &&
@@ -133,7 +179,13 @@ void Motogame::updateBlock()
         m_Templates.pop_front();
 
     // Save all block templates. We may need older template because player may solve not the last block.
-    m_Templates.push_back(std::move(pBlockTemplate));
+    // Job ID is never zero, zero means hex message.
+    Job NewJob;
+    NewJob.JobId = m_NextJobId++;
+    if (m_NextJobId == 0)
+        m_NextJobId = 1;
+    NewJob.pTemplate = std::move(pBlockTemplate);
+    m_Templates.push_back(std::move(NewJob));
 
     // Construct work.
     MotoWork Work;
@@ -143,8 +195,8 @@ void Motogame::updateBlock()
     memcpy(Work.Block, &pBlock->nVersion, sizeof(Work.Block));
 
     // Send work message to motogame.
-    std::string Msg = motoMessage(Work);
-    m_Motogame.write(Msg.c_str());
+    std::string Msg = m_Binary ? motoFrame(m_Templates.back().JobId, Work) : motoMessage(Work);
+    m_Motogame.write(Msg.data(), Msg.size());
 }
 
 void startMining(bool LowQ, bool OGL3, CWallet* pWallet)
@@ -7,22 +7,36 @@
 #include <memory>
 #include "main.h"
 #include "wallet.h"
+#include "moto-protocol.h"
 
 class Motogame : public QObject
 {
     Q_OBJECT
 
+    struct Job
+    {
+        unsigned int JobId;
+        std::unique_ptr<CBlockTemplate> pTemplate;
+    };
+
     QProcess m_Motogame;
+    CMotoReader m_Reader;
+    bool m_Binary; // motogame accepted binary framing.
+    unsigned int m_NextJobId;
 
     CWallet* m_pWallet;
     CReserveKey m_ReserveKey;
     CBlockIndex* m_pPrevBest;
+    unsigned int m_TemplateVersion; // Version of live template the last job was made from.
+    int64 m_LastUpdate;             // Time when the last job was made.
 
-    std::list<std::unique_ptr<CBlockTemplate>> m_Templates;
+    std::list<Job> m_Templates;
 
     void updateBlock();
+    void submit(std::list<Job>::iterator iter, const MotoPoW& PoW);
 
-    std::list<std::unique_ptr<CBlockTemplate>>::iterator findBlock(const MotoWork& Work);
+    std::list<Job>::iterator findBlock(const MotoWork& Work);
+    std::list<Job>::iterator findBlock(unsigned int JobId);
 
     void timerEvent(QTimerEvent *event);
 
@@ -7,6 +7,8 @@
 #include "db.h"
 #include "init.h"
 #include "bitcoinrpc.h"
+#include "livetemplate.h"
+#include "workserver.h"
 
 using namespace json_spirit;
 using namespace std;
@@ -82,6 +84,44 @@ Value getmininginfo(const Array& params, bool fHelp)
 }
 
 
+Value getworkserverinfo(const Array& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getworkserverinfo\n"
+            "Returns data about each solver connected to work server (see -workserver).");
+
+    vector<CWorkClientStats> vstats = getWorkServerStats();
+
+    Array ret;
+    BOOST_FOREACH(const CWorkClientStats& stats, vstats)
+    {
+        Object obj;
+        obj.push_back(Pair("addr", stats.Address));
+        obj.push_back(Pair("conntime", (boost::int64_t)stats.ConnectedTime));
+        obj.push_back(Pair("lastshare", (boost::int64_t)stats.LastShareTime));
+        obj.push_back(Pair("shares", (boost::int64_t)stats.NumShares));
+        obj.push_back(Pair("blocks", (boost::int64_t)stats.NumBlocks));
+        obj.push_back(Pair("stale", (boost::int64_t)stats.NumStale));
+        obj.push_back(Pair("invalid", (boost::int64_t)stats.NumInvalid));
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
+
+// Blocks given out by getworkex by their merkle root, which is also template ID for submitpow.
+// getworkex changes extra nonce of the same block for each call and may replace whole coinbase
+// on submission, so coinbase and time given out are saved with it. Accessed only under cs_main (getworkex and submitpow are not thread safe).
+struct CWorkExBlock
+{
+    CBlock* pblock;
+    CTransaction txCoinbase;
+    unsigned int nTime;
+};
+typedef map<uint256, CWorkExBlock> mapWorkExBlock_t;
+static mapWorkExBlock_t mapWorkExBlock;
+
 Value getworkex(const Array& params, bool fHelp)
 {
     if (fHelp || params.size() > 2)
@@ -96,8 +136,6 @@ Value getworkex(const Array& params, bool fHelp)
     if (IsInitialBlockDownload())
         throw JSONRPCError(RPC_CLIENT_IN_INITIAL_DOWNLOAD, "Motocoin is downloading blocks...");
 
-    typedef map<uint256, pair<CBlock*, CScript> > mapNewBlock_t;
-    static mapNewBlock_t mapNewBlock;    // FIXME: thread safety
     static vector<CBlockTemplate*> vNewBlockTemplate;
     static CReserveKey reservekey(pwalletMain);
 
@@ -114,7 +152,7 @@ Value getworkex(const Array& params, bool fHelp)
             if (pindexPrev != pindexBest)
             {
                 // Deallocate old blocks since they're obsolete now
-                mapNewBlock.clear();
+                mapWorkExBlock.clear();
                 BOOST_FOREACH(CBlockTemplate* pblocktemplate, vNewBlockTemplate)
                     delete pblocktemplate;
                 vNewBlockTemplate.clear();
@@ -129,7 +167,7 @@ Value getworkex(const Array& params, bool fHelp)
             nStart = GetTime();
 
             // Create new block
-            pblocktemplate = CreateNewBlockWithKey(*pMiningKey);
+            pblocktemplate = getLiveTemplate(*pMiningKey, true);
             if (!pblocktemplate)
                 throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
             vNewBlockTemplate.push_back(pblocktemplate);
@@ -148,7 +186,10 @@ Value getworkex(const Array& params, bool fHelp)
         IncrementExtraNonce(pblock, pindexPrev, nExtraNonce);
 
         // Save
-        mapNewBlock[pblock->hashMerkleRoot] = make_pair(pblock, pblock->vtx[0].vin[0].scriptSig);
+        CWorkExBlock& workex = mapWorkExBlock[pblock->hashMerkleRoot];
+        workex.pblock = pblock;
+        workex.txCoinbase = pblock->vtx[0];
+        workex.nTime = pblock->nTime;
 
         // Pre-build hash buffers
         char pdata[256];
@@ -159,6 +200,7 @@ Value getworkex(const Array& params, bool fHelp)
 
         Object result;
         result.push_back(Pair("data",     HexStr(BEGIN(pdata), END(pdata))));
+        result.push_back(Pair("templateid", pblock->hashMerkleRoot.GetHex()));
         result.push_back(Pair("target",   (int64_t)pblock->nBits));
         result.push_back(Pair("algorithm", "motogame"));
 
@@ -196,15 +238,15 @@ Value getworkex(const Array& params, bool fHelp)
             ((unsigned int*)pdata)[i] = ByteReverse(((unsigned int*)pdata)[i]);
 
         // Get saved block
-        if (!mapNewBlock.count(pdata->hashMerkleRoot))
+        if (!mapWorkExBlock.count(pdata->hashMerkleRoot))
             return false;
-        CBlock* pblock = mapNewBlock[pdata->hashMerkleRoot].first;
+        CBlock* pblock = mapWorkExBlock[pdata->hashMerkleRoot].pblock;
 
         pblock->nTime = pdata->nTime;
         pblock->Nonce = pdata->Nonce;
 
         if(coinbase.size() == 0)
-            pblock->vtx[0].vin[0].scriptSig = mapNewBlock[pdata->hashMerkleRoot].second;
+            pblock->vtx[0] = mapWorkExBlock[pdata->hashMerkleRoot].txCoinbase;
         else
             CDataStream(coinbase, SER_NETWORK, PROTOCOL_VERSION) >> pblock->vtx[0];
 
@@ -215,6 +257,50 @@ Value getworkex(const Array& params, bool fHelp)
 }
 
 
+Value submitpow(const Array& params, bool fHelp)
+{
+    if (fHelp || params.size() != 2)
+        throw runtime_error(
+            "submitpow <templateid> <pow>\n"
+            "Submits solution of work returned by getworkex.\n"
+            "<templateid> is its \"templateid\", <pow> is hex encoded MotoPoW,\n"
+            "unused updates at its end may be omitted.\n"
+            "Returns true if block was accepted.");
+
+    uint256 hashTemplate;
+    hashTemplate.SetHex(params[0].get_str());
+
+    vector<unsigned char> vchPoW = ParseHex(params[1].get_str());
+    const size_t nPoWHeaderSize = offsetof(MotoPoW, Updates);
+    if (vchPoW.size() < nPoWHeaderSize || vchPoW.size() > sizeof(MotoPoW) ||
+        (vchPoW.size() - nPoWHeaderSize) % sizeof(uint16_t) != 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter");
+    MotoPoW pow;
+    motoInitPoW(&pow);
+    memcpy(&pow, &vchPoW[0], vchPoW.size());
+
+    // Work is stale if tip has changed since
+    mapWorkExBlock_t::iterator mi = mapWorkExBlock.find(hashTemplate);
+    if (mi == mapWorkExBlock.end())
+        return false;
+    CBlock* pblock = mi->second.pblock;
+
+    pblock->nTime = mi->second.nTime;
+    pblock->Nonce = pow;
+
+    // Merkle root is rebuilt only if block was given out again after this template
+    if (pblock->hashMerkleRoot != hashTemplate)
+    {
+        pblock->vtx[0] = mi->second.txCoinbase;
+        pblock->hashMerkleRoot = pblock->BuildMerkleTree();
+        if (pblock->hashMerkleRoot != hashTemplate)
+            throw JSONRPCError(RPC_MISC_ERROR, "Saved block doesn't match template");
+    }
+
+    return CheckWork(pblock, *pwalletMain, *pMiningKey);
+}
+
+
 Value getwork(const Array& params, bool fHelp)
 {
     if (fHelp || params.size() > 1)
@@ -264,7 +350,7 @@ Value getwork(const Array& params, bool fHelp)
             nStart = GetTime();
 
             // Create new block
-            pblocktemplate = CreateNewBlockWithKey(*pMiningKey);
+            pblocktemplate = getLiveTemplate(*pMiningKey, true);
             if (!pblocktemplate)
                 throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
             vNewBlockTemplate.push_back(pblocktemplate);
@@ -393,7 +479,7 @@ Value getblocktemplate(const Array& params, bool fHelp)
             pblocktemplate = NULL;
         }
         CScript scriptDummy = CScript() << OP_TRUE;
-        pblocktemplate = CreateNewBlock(scriptDummy);
+        pblocktemplate = getLiveTemplate(scriptDummy, true);
         if (!pblocktemplate)
             throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
 
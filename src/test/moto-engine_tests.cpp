@@ -0,0 +1,313 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+#include "json/json_spirit_reader_template.h"
+#include "json/json_spirit_writer_template.h"
+#include "json/json_spirit_utils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "hash.h"
+#include "util.h"
+#include "moto-engine.h"
+
+using namespace std;
+using namespace json_spirit;
+extern Array read_json(const std::string& filename);
+
+//
+// Optimized engine paths must produce exactly the same game as the reference,
+// otherwise nodes would disagree about validity of blocks (CBlock::CheckPoW uses motoCheck).
+//
+// moto_engine_golden.json was generated with the original engine (before any optimization).
+// Each test is [block, MotoPoW, motoCheck result, [[frame, digest], ...], comment].
+// Digest is a chain of Hash() over all states up to and including that frame,
+// the last frame listed is the last simulated frame.
+//
+// Set MOTO_FUZZ_ITERATIONS to run more random inputs through moto_engine_fuzz.
+//
+
+// Serialize all fields of the state, independently of padding and byte order.
+static void AppendState(vector<unsigned char>& vch, const MotoState& state)
+{
+    CDataStream ss(SER_GETHASH, 0);
+    const MotoBody* bodies[3] = {&state.Wheels[0], &state.Wheels[1], &state.Bike};
+    ss << state.iFrame << state.iLastRotate << (int32_t)state.Accel << (int32_t)state.Rotation;
+    for (int i = 0; i < 3; i++)
+        ss << bodies[i]->Pos[0] << bodies[i]->Pos[1] << bodies[i]->Vel[0] << bodies[i]->Vel[1] << bodies[i]->AngPos << bodies[i]->AngVel;
+    ss << state.HeadPos[0] << state.HeadPos[1] << state.HeadVel[0] << state.HeadVel[1];
+    ss << (unsigned char)state.Dead << (int32_t)state.curState << state.finishDistSq;
+    vch.insert(vch.end(), ss.begin(), ss.end());
+}
+
+static bool StatesEqual(const MotoState& a, const MotoState& b)
+{
+    vector<unsigned char> vchA, vchB;
+    AppendState(vchA, a);
+    AppendState(vchB, b);
+    return vchA == vchB;
+}
+
+// Game replayed with reference path, state after every frame.
+struct CTrace
+{
+    MotoWorld world;
+    vector<MotoState> states;
+    int nFrames;
+    bool fResult;
+};
+
+static bool ReplayTrace(const uint8_t* pBlock, const MotoPoW& pow, CTrace& trace)
+{
+    MotoState state;
+    if (!motoGenerateWorld(&trace.world, &state, pBlock, pow.Nonce))
+        return false;
+    trace.states.resize(MOTO_MAX_FRAMES + 1);
+    trace.states[0] = state;
+    MotoPoW powCopy = pow;
+    trace.fResult = motoReplayWithTrace(&state, &powCopy, &trace.world, MOTO_MAX_FRAMES + 10, &trace.states[0]);
+    trace.nFrames = state.iFrame;
+    return true;
+}
+
+// Compare all other replay paths to the trace, frame by frame where they allow it.
+static void CheckPaths(const uint8_t* pBlock, const MotoPoW& pow, const CTrace& trace, const string& strTest)
+{
+    const MotoState& first = trace.states[0];
+    const MotoState& last = trace.states[trace.nFrames];
+
+    // Complete check.
+    MotoPoW powCheck = pow;
+    BOOST_CHECK_MESSAGE(motoCheck(pBlock, &powCheck) == trace.fResult, strTest);
+
+    // Replay stopped at some frame.
+    for (int nToFrame = 1; nToFrame < trace.nFrames; nToFrame += 97)
+    {
+        MotoState state = first;
+        MotoPoW powCopy = pow;
+        motoReplay(&state, &powCopy, &trace.world, nToFrame);
+        BOOST_CHECK_MESSAGE(StatesEqual(state, trace.states[nToFrame]), strTest << " motoReplay to frame " << nToFrame);
+    }
+
+    // Replay with checkpoints and resume from each of them.
+    MotoState checkpoints[MOTO_MAX_INPUTS];
+    int nCheckpoints = 0;
+    MotoState state = first;
+    MotoPoW powCopy = pow;
+    bool fResult = motoReplayWithCheckpoints(&state, &powCopy, &trace.world, MOTO_MAX_FRAMES + 10, checkpoints, &nCheckpoints);
+    BOOST_CHECK_MESSAGE(fResult == trace.fResult && StatesEqual(state, last), strTest << " motoReplayWithCheckpoints");
+    for (int i = 0; i < nCheckpoints; i++)
+    {
+        BOOST_CHECK_MESSAGE(StatesEqual(checkpoints[i], trace.states[checkpoints[i].iFrame]), strTest << " checkpoint " << i);
+
+        MotoState checkpointsResumed[MOTO_MAX_INPUTS];
+        int nCheckpointsResumed = i;
+        state = checkpoints[i];
+        powCopy = pow;
+        fResult = motoReplayWithCheckpoints(&state, &powCopy, &trace.world, MOTO_MAX_FRAMES + 10, checkpointsResumed, &nCheckpointsResumed);
+        BOOST_CHECK_MESSAGE(fResult == trace.fResult && StatesEqual(state, last), strTest << " resumed from checkpoint " << i);
+    }
+
+    // Bounded replay must stop only candidates that really can't beat the bound.
+    const int64_t bounds[4] = {0, last.finishDistSq / 2, last.finishDistSq, last.finishDistSq + 1};
+    for (int i = 0; i < 4; i++)
+    {
+        state = first;
+        powCopy = pow;
+        fResult = motoReplayBounded(&state, &powCopy, &trace.world, MOTO_MAX_FRAMES + 10, NULL, NULL, bounds[i]);
+        if (state.iFrame == trace.nFrames)
+            BOOST_CHECK_MESSAGE(fResult == trace.fResult && StatesEqual(state, last), strTest << " motoReplayBounded " << bounds[i]);
+        else
+            BOOST_CHECK_MESSAGE(!trace.fResult && state.finishDistSq >= bounds[i] && state.finishDistSq <= last.finishDistSq, strTest << " motoReplayBounded stopped " << bounds[i]);
+    }
+
+    // Batch of candidates that share a prefix of input.
+    const int nCandidates = 4;
+    MotoPoW pows[nCandidates];
+    MotoState states[nCandidates];
+    bool results[nCandidates];
+    CTrace traces[nCandidates];
+    for (int c = 0; c < nCandidates; c++)
+    {
+        pows[c] = pow;
+        if (c > 0 && pow.NumUpdates > c)
+        {
+            // Change delay of one of later updates, it may become invalid and that is fine.
+            uint16_t& update = pows[c].Updates[pow.NumUpdates - c];
+            if (update / 12 > 1)
+                update -= 12;
+        }
+        BOOST_REQUIRE(ReplayTrace(pBlock, pows[c], traces[c]));
+        states[c] = first;
+    }
+    motoReplayBatch(states, pows, results, nCandidates, &trace.world, MOTO_MAX_FRAMES + 10);
+    for (int c = 0; c < nCandidates; c++)
+        BOOST_CHECK_MESSAGE(results[c] == traces[c].fResult && StatesEqual(states[c], traces[c].states[traces[c].nFrames]), strTest << " motoReplayBatch candidate " << c);
+}
+
+// Random input with changes every few seconds. Some rotations are placed exactly at the limit of rotation period.
+static void RandomPoW(MotoPoW& pow)
+{
+    MotoState state;
+    motoInitPoW(&pow);
+    pow.NumFrames = 2000 + insecure_rand() % 5500;
+    state.iFrame = 0;
+    int nLastRotation = -1000;
+    EMotoAccel accel = MOTO_GAS_RIGHT;
+    while (true)
+    {
+        state.iFrame += 1 + insecure_rand() % 300;
+        if (insecure_rand() % 4 == 0 && state.iFrame - nLastRotation < 200)
+            state.iFrame = nLastRotation + 199 + insecure_rand() % 3;
+        if (state.iFrame >= pow.NumFrames)
+            break;
+
+        EMotoRot rotation = MOTO_NO_ROTATION;
+        if (state.iFrame - nLastRotation >= 199 && insecure_rand() % 2)
+        {
+            rotation = (insecure_rand() % 2) ? MOTO_ROTATE_CW : MOTO_ROTATE_CCW;
+            nLastRotation = state.iFrame;
+        }
+        if (insecure_rand() % 3 == 0)
+            accel = (accel == MOTO_GAS_RIGHT) ? MOTO_GAS_LEFT : MOTO_GAS_RIGHT;
+        if (!recordInput(&pow, &state, accel, rotation))
+            break;
+    }
+}
+
+static void AddUpdate(MotoPoW& pow, int nDelta, EMotoAccel accel, EMotoRot rotation)
+{
+    pow.Updates[pow.NumUpdates++] = nDelta*12 + rotation*4 + accel;
+}
+
+BOOST_AUTO_TEST_SUITE(moto_engine_tests)
+
+BOOST_AUTO_TEST_CASE(moto_engine_golden)
+{
+    Array tests = read_json("moto_engine_golden.json");
+
+    BOOST_FOREACH(Value& tv, tests)
+    {
+        Array test = tv.get_array();
+        string strTest = write_string(tv, false).substr(0, 80);
+        if (test.size() < 4)
+        {
+            BOOST_ERROR("Bad test: " << strTest);
+            continue;
+        }
+        vector<unsigned char> vchBlock = ParseHex(test[0].get_str());
+        vector<unsigned char> vchPoW = ParseHex(test[1].get_str());
+        bool fExpected = test[2].get_bool();
+        Array digests = test[3].get_array();
+        if (vchBlock.size() != MOTO_WORK_SIZE || vchPoW.size() != sizeof(MotoPoW) || digests.empty())
+        {
+            BOOST_ERROR("Bad test: " << strTest);
+            continue;
+        }
+        MotoPoW pow;
+        memcpy(&pow, &vchPoW[0], sizeof(pow));
+
+        CTrace trace;
+        BOOST_REQUIRE_MESSAGE(ReplayTrace(&vchBlock[0], pow, trace), strTest);
+        BOOST_CHECK_MESSAGE(trace.nFrames == digests.back().get_array()[0].get_int(), strTest << " number of frames");
+
+        // Report first block of frames that differs, compare whole state after each frame.
+        vector<unsigned char> vch;
+        AppendState(vch, trace.states[0]);
+        uint256 hash = Hash(vch.begin(), vch.end());
+        unsigned int iDigest = 0;
+        int nPrevFrame = 0;
+        for (int nFrame = 1; nFrame <= trace.nFrames && iDigest < digests.size(); nFrame++)
+        {
+            vch.assign(hash.begin(), hash.end());
+            AppendState(vch, trace.states[nFrame]);
+            hash = Hash(vch.begin(), vch.end());
+
+            Array digest = digests[iDigest].get_array();
+            if (digest[0].get_int() != nFrame)
+                continue;
+            if (hash.GetHex() != digest[1].get_str())
+            {
+                BOOST_ERROR(strTest << " differs between frames " << nPrevFrame << " and " << nFrame);
+                break;
+            }
+            nPrevFrame = nFrame;
+            iDigest++;
+        }
+
+        MotoPoW powCheck = pow;
+        BOOST_CHECK_MESSAGE(motoCheck(&vchBlock[0], &powCheck) == fExpected, strTest << " motoCheck");
+        BOOST_CHECK_MESSAGE(trace.fResult == fExpected, strTest << " motoReplayWithTrace");
+
+        CheckPaths(&vchBlock[0], pow, trace, strTest);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(moto_engine_fuzz)
+{
+    int nIterations = 8;
+    const char* pszIterations = getenv("MOTO_FUZZ_ITERATIONS");
+    if (pszIterations)
+        nIterations = atoi(pszIterations);
+
+    seed_insecure_rand(true);
+    for (int i = 0; i < nIterations; i++)
+    {
+        uint8_t block[MOTO_WORK_SIZE];
+        for (int j = 0; j < MOTO_WORK_SIZE; j++)
+            block[j] = insecure_rand();
+
+        MotoPoW pow;
+        RandomPoW(pow);
+        CTrace trace;
+        pow.Nonce = insecure_rand();
+        while (!ReplayTrace(block, pow, trace))
+            pow.Nonce++;
+
+        CheckPaths(block, pow, trace, strprintf("fuzz iteration %d", i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(moto_engine_valid_input)
+{
+    MotoPoW pow;
+    motoInitPoW(&pow);
+    pow.NumFrames = 1000;
+    BOOST_CHECK(motoIsValidInput(&pow));
+
+    // Gas, then rotations exactly at the limit of rotation period.
+    AddUpdate(pow, 375, MOTO_GAS_RIGHT, MOTO_NO_ROTATION);
+    AddUpdate(pow, 225, MOTO_GAS_RIGHT, MOTO_ROTATE_CW);
+    AddUpdate(pow, 200, MOTO_GAS_LEFT, MOTO_ROTATE_CCW);
+    BOOST_CHECK(motoIsValidInput(&pow));
+
+    MotoPoW powBad = pow;
+    powBad.Updates[2] -= 12;
+    BOOST_CHECK(!motoIsValidInput(&powBad));
+
+    // All updates must be before the last frame.
+    powBad = pow;
+    powBad.NumFrames = 800;
+    BOOST_CHECK(!motoIsValidInput(&powBad));
+
+    // Update that changes nothing is allowed only as a filler of long gap.
+    powBad = pow;
+    AddUpdate(powBad, 100, MOTO_GAS_LEFT, MOTO_NO_ROTATION);
+    BOOST_CHECK(!motoIsValidInput(&powBad));
+    MotoPoW powFiller = pow;
+    powFiller.NumFrames = 7000;
+    AddUpdate(powFiller, 5460, MOTO_GAS_LEFT, MOTO_NO_ROTATION);
+    BOOST_CHECK(motoIsValidInput(&powFiller));
+
+    // Two updates at the same frame.
+    powBad = pow;
+    AddUpdate(powBad, 0, MOTO_GAS_RIGHT, MOTO_NO_ROTATION);
+    BOOST_CHECK(!motoIsValidInput(&powBad));
+
+    powBad = pow;
+    powBad.NumUpdates = MOTO_MAX_INPUTS + 1;
+    BOOST_CHECK(!motoIsValidInput(&powBad));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
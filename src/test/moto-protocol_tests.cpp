@@ -0,0 +1,150 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "moto-protocol.h"
+
+using namespace std;
+
+static void RandomWork(MotoWork& work, int nSeed)
+{
+    memset(&work, 0, sizeof(work));
+    work.IsNew = nSeed & 1;
+    work.TimeTarget = 250*60 + nSeed;
+    strncpy(work.Msg, "Block 1.", sizeof(work.Msg));
+    for (int i = 0; i < MOTO_WORK_SIZE; i++)
+        work.Block[i] = (uint8_t)(i*31 + nSeed);
+}
+
+static void RandomPoW(MotoPoW& pow, int nSeed)
+{
+    motoInitPoW(&pow);
+    pow.Nonce = 0x12345678 + nSeed;
+    pow.NumFrames = 1000 + nSeed;
+    pow.NumUpdates = MOTO_MAX_INPUTS;
+    for (int i = 0; i < MOTO_MAX_INPUTS; i++)
+        pow.Updates[i] = (uint16_t)(i*12 + nSeed*4 + 1);
+}
+
+// Read whole stream, fed to the reader in chunks of given size.
+static vector<MotoMessage> ReadAll(const string& strData, size_t nChunk)
+{
+    CMotoReader reader;
+    vector<MotoMessage> vMsg;
+    MotoMessage msg;
+    for (size_t nPos = 0; nPos < strData.size(); nPos += nChunk)
+    {
+        reader.append(strData.data() + nPos, min(nChunk, strData.size() - nPos));
+        while (reader.next(msg))
+            vMsg.push_back(msg);
+    }
+    return vMsg;
+}
+
+BOOST_AUTO_TEST_SUITE(moto_protocol_tests)
+
+BOOST_AUTO_TEST_CASE(moto_protocol_roundtrip)
+{
+    MotoWork work, work2;
+    MotoPoW pow, pow2;
+    RandomWork(work, 1);
+    RandomWork(work2, 2);
+    RandomPoW(pow, 1);
+    RandomPoW(pow2, 2);
+
+    // Hex lines and frames mixed in one stream, as when the other side switches to frames.
+    string strData = motoHelloMessage() + motoMessage(work) + "Error: something\r\n" + motoMessage(work, pow) +
+        motoFrame(7, work2) + motoFrame(8, pow2) + motoCancelFrame(9);
+
+    size_t vChunks[] = {1, 3, 7, 64, strData.size()};
+    for (unsigned int i = 0; i < sizeof(vChunks)/sizeof(vChunks[0]); i++)
+    {
+        vector<MotoMessage> vMsg = ReadAll(strData, vChunks[i]);
+        BOOST_REQUIRE_EQUAL(vMsg.size(), 7U);
+
+        BOOST_CHECK_EQUAL(vMsg[0].Type, MOTO_MSG_HELLO);
+        BOOST_CHECK_EQUAL(vMsg[0].Version, MOTO_FRAME_VERSION);
+
+        BOOST_CHECK_EQUAL(vMsg[1].Type, MOTO_MSG_WORK);
+        BOOST_CHECK_EQUAL(vMsg[1].JobId, 0U);
+        BOOST_CHECK(memcmp(&vMsg[1].Work, &work, sizeof(work)) == 0);
+
+        BOOST_CHECK_EQUAL(vMsg[2].Type, MOTO_MSG_TEXT);
+        BOOST_CHECK_EQUAL(vMsg[2].Text, "Error: something");
+
+        BOOST_CHECK_EQUAL(vMsg[3].Type, MOTO_MSG_WORK_POW);
+        BOOST_CHECK(memcmp(&vMsg[3].Work, &work, sizeof(work)) == 0);
+        BOOST_CHECK(memcmp(&vMsg[3].PoW, &pow, sizeof(pow)) == 0);
+
+        BOOST_CHECK_EQUAL(vMsg[4].Type, MOTO_MSG_WORK);
+        BOOST_CHECK_EQUAL(vMsg[4].JobId, 7U);
+        BOOST_CHECK(memcmp(&vMsg[4].Work, &work2, sizeof(work2)) == 0);
+
+        BOOST_CHECK_EQUAL(vMsg[5].Type, MOTO_MSG_SOLUTION);
+        BOOST_CHECK_EQUAL(vMsg[5].JobId, 8U);
+        BOOST_CHECK(memcmp(&vMsg[5].PoW, &pow2, sizeof(pow2)) == 0);
+
+        BOOST_CHECK_EQUAL(vMsg[6].Type, MOTO_MSG_CANCEL);
+        BOOST_CHECK_EQUAL(vMsg[6].JobId, 9U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(moto_protocol_unknown_frames)
+{
+    MotoWork work;
+    RandomWork(work, 3);
+
+    // Frames of other versions, of unknown types or with wrong size are skipped whole.
+    string strOther = motoFrame(1, work);
+    strOther[1] = MOTO_FRAME_VERSION + 1;
+    string strUnknown = motoCancelFrame(2);
+    strUnknown[2] = 100;
+    string strShort = motoFrame(3, work);
+    strShort[8] = 10;
+    strShort.resize(12 + 10);
+
+    vector<MotoMessage> vMsg = ReadAll(strOther + strUnknown + strShort + motoCancelFrame(4), 5);
+    BOOST_REQUIRE_EQUAL(vMsg.size(), 1U);
+    BOOST_CHECK_EQUAL(vMsg[0].Type, MOTO_MSG_CANCEL);
+    BOOST_CHECK_EQUAL(vMsg[0].JobId, 4U);
+
+    // Incomplete frame waits for the rest of data.
+    string strFrame = motoFrame(5, work);
+    CMotoReader reader;
+    MotoMessage msg;
+    reader.append(strFrame.data(), strFrame.size() - 1);
+    BOOST_CHECK(!reader.next(msg));
+    reader.append(strFrame.data() + strFrame.size() - 1, 1);
+    BOOST_CHECK(reader.next(msg));
+    BOOST_CHECK_EQUAL(msg.JobId, 5U);
+    BOOST_CHECK(!reader.next(msg));
+}
+
+BOOST_AUTO_TEST_CASE(moto_protocol_long_line)
+{
+    MotoWork work;
+    RandomWork(work, 4);
+
+    // Line without end is not buffered forever.
+    CMotoReader reader;
+    MotoMessage msg;
+    string strJunk(1000, 'x');
+    for (int i = 0; i < 10; i++)
+    {
+        reader.append(strJunk.data(), strJunk.size());
+        BOOST_CHECK(!reader.next(msg));
+    }
+    BOOST_CHECK(reader.hasOverflowed());
+
+    // Longest valid line doesn't overflow.
+    CMotoReader reader2;
+    string strMsg = motoMessage(work, MotoPoW());
+    reader2.append(strMsg.data(), strMsg.size());
+    BOOST_CHECK(reader2.next(msg));
+    BOOST_CHECK_EQUAL(msg.Type, MOTO_MSG_WORK_POW);
+    BOOST_CHECK(!reader2.hasOverflowed());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,408 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// Work server for solvers on the same machine or LAN.
+//--------------------------------------------------------------------
+
+#include <deque>
+#include <list>
+#include <set>
+#include <sstream>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include "main.h"
+#include "init.h"
+#include "wallet.h"
+#include "ui_interface.h"
+#include "moto-protocol.h"
+#include "livetemplate.h"
+#include "workserver.h"
+
+using namespace boost::asio;
+
+static const int g_MaxJobs = 16;              // Solution of older job of the same block is still accepted.
+static const int64 g_UpdateInterval = 60;     // Seconds, work gets new transactions and fresh nTime so often.
+static const size_t g_MaxOutput = 64;         // Messages queued for solver that doesn't read them, then it is disconnected.
+
+struct CWorkJob
+{
+    uint32_t Id;
+    boost::shared_ptr<CBlockTemplate> pTemplate;
+    MotoWork Work;
+};
+
+class CWorkClient : public boost::enable_shared_from_this<CWorkClient>
+{
+public:
+    ip::tcp::socket m_Socket;
+    bool m_Subscribed;         // Hello was answered, solver gets new work.
+    CWorkClientStats m_Stats;  // Guarded by g_csClients.
+
+    CWorkClient();
+    void start();
+    void send(const std::string& Msg);
+    void close();
+
+private:
+    CMotoReader m_Reader;
+    char m_Buffer[4096];
+    std::deque<std::string> m_Output;
+
+    void read();
+    void onRead(const boost::system::error_code& Error, std::size_t NumBytes);
+    void onWrite(const boost::system::error_code& Error);
+    void onMessage(const MotoMessage& Msg);
+};
+
+static io_service g_IOService;
+static ip::tcp::acceptor g_Acceptor(g_IOService);
+static deadline_timer g_Timer(g_IOService);
+static boost::thread g_Thread;
+static boost::signals2::connection g_BlocksChanged;
+
+// Used only in server thread.
+static CReserveKey* g_pReserveKey = NULL;
+static std::list<CWorkJob> g_Jobs;
+static uint32_t g_NextJobId = 1;
+static unsigned int g_ExtraNonce = 0;
+static CBlockIndex* g_pPrevBest = NULL;
+static int64 g_LastUpdate = 0;
+
+static CCriticalSection g_csClients;
+static std::set<boost::shared_ptr<CWorkClient> > g_Clients;
+
+unsigned short getDefaultWorkServerPort()
+{
+    return GetBoolArg("-testnet", false) ? 26107 : 13107;
+}
+
+// Same rules as for JSON-RPC connections.
+static bool isAllowed(const ip::address& Address)
+{
+    if (Address.is_v6() && (Address.to_v6().is_v4_compatible() || Address.to_v6().is_v4_mapped()))
+        return isAllowed(Address.to_v6().to_v4());
+
+    if (Address == ip::address_v4::loopback() || Address == ip::address_v6::loopback())
+        return true;
+
+    const std::string Str = Address.to_string();
+    const std::vector<std::string>& Allowed = mapMultiArgs["-workserverallowip"];
+    BOOST_FOREACH(const std::string& Allow, Allowed)
+        if (WildcardMatch(Str, Allow))
+            return true;
+    return false;
+}
+
+static void broadcast(const std::string& Msg)
+{
+    std::vector<boost::shared_ptr<CWorkClient> > Clients;
+    {
+        LOCK(g_csClients);
+        Clients.assign(g_Clients.begin(), g_Clients.end());
+    }
+    BOOST_FOREACH(const boost::shared_ptr<CWorkClient>& pClient, Clients)
+        if (pClient->m_Subscribed)
+            pClient->send(Msg);
+}
+
+// Make new job if tip has changed or if the last one is old, and push it to solvers.
+// Old job is replaced even if no transactions came, so that its nTime doesn't fall behind.
+static void updateWork()
+{
+    if (IsInitialBlockDownload())
+        return;
+
+    LOCK(cs_main);
+    bool IsNew = (g_pPrevBest != pindexBest);
+    if (!IsNew && GetTime() - g_LastUpdate < g_UpdateInterval)
+        return;
+
+    boost::shared_ptr<CBlockTemplate> pTemplate(getLiveTemplate(*g_pReserveKey, true));
+    if (!pTemplate)
+        return;
+    CBlock* pBlock = &pTemplate->block;
+    IncrementExtraNonce(pBlock, pindexBest, g_ExtraNonce);
+
+    g_pPrevBest = pindexBest;
+    g_LastUpdate = GetTime();
+
+    if (IsNew)
+        g_Jobs.clear();
+    if ((int)g_Jobs.size() >= g_MaxJobs)
+        g_Jobs.pop_front();
+
+    CWorkJob Job;
+    Job.Id = g_NextJobId++;
+    if (g_NextJobId == 0)
+        g_NextJobId = 1;
+    Job.pTemplate = pTemplate;
+    Job.Work.IsNew = IsNew;
+    Job.Work.TimeTarget = pBlock->nBits;
+    snprintf(Job.Work.Msg, sizeof(Job.Work.Msg), "Block %i, Reward %f MOTO, Target %.3f.", pindexBest->nHeight + 1, pBlock->vtx[0].vout[0].nValue/100000000.0, Job.Work.TimeTarget/250.0);
+    memcpy(Job.Work.Block, &pBlock->nVersion, sizeof(Job.Work.Block));
+    g_Jobs.push_back(Job);
+
+    broadcast(motoFrame(Job.Id, Job.Work));
+}
+
+static void submit(CWorkClient& Client, uint32_t JobId, const MotoPoW& PoW)
+{
+    CWorkJob* pJob = NULL;
+    BOOST_FOREACH(CWorkJob& Job, g_Jobs)
+        if (Job.Id == JobId)
+            pJob = &Job;
+
+    bool Valid = false;
+    bool Accepted = false;
+    if (pJob)
+    {
+        CBlock* pBlock = &pJob->pTemplate->block;
+        pBlock->Nonce = PoW;
+        Valid = pBlock->CheckPoW();
+        if (Valid)
+            Accepted = CheckWork(pBlock, *pwalletMain, *g_pReserveKey);
+    }
+
+    LOCK(g_csClients);
+    CWorkClientStats& Stats = Client.m_Stats;
+    if (!pJob)
+        Stats.NumStale++;
+    else if (!Valid)
+        Stats.NumInvalid++;
+    else
+    {
+        Stats.NumShares++;
+        Stats.LastShareTime = GetTime();
+        if (Accepted)
+            Stats.NumBlocks++;
+    }
+    printf("WorkServer: solution of job %u from %s: %s\n", JobId, Stats.Address.c_str(),
+        !pJob ? "stale" : !Valid ? "invalid" : Accepted ? "block" : "not accepted");
+}
+
+CWorkClient::CWorkClient() :
+    m_Socket(g_IOService),
+    m_Subscribed(false)
+{
+    m_Stats.ConnectedTime = GetTime();
+    m_Stats.LastShareTime = 0;
+    m_Stats.NumShares = 0;
+    m_Stats.NumBlocks = 0;
+    m_Stats.NumStale = 0;
+    m_Stats.NumInvalid = 0;
+}
+
+void CWorkClient::start()
+{
+    boost::system::error_code Error;
+    ip::tcp::endpoint Remote = m_Socket.remote_endpoint(Error);
+    if (Error || !isAllowed(Remote.address()))
+    {
+        m_Socket.close(Error);
+        return;
+    }
+
+    // Solutions are small and must be delivered at once.
+    m_Socket.set_option(ip::tcp::no_delay(true), Error);
+    {
+        LOCK(g_csClients);
+        std::ostringstream Address;
+        Address << Remote;
+        m_Stats.Address = Address.str();
+        m_Stats.ConnectedTime = GetTime();
+        g_Clients.insert(shared_from_this());
+    }
+    printf("WorkServer: solver connected from %s\n", m_Stats.Address.c_str());
+    read();
+}
+
+void CWorkClient::close()
+{
+    boost::system::error_code Error;
+    if (m_Socket.is_open())
+        m_Socket.close(Error);
+
+    LOCK(g_csClients);
+    g_Clients.erase(shared_from_this());
+}
+
+void CWorkClient::read()
+{
+    m_Socket.async_read_some(buffer(m_Buffer, sizeof(m_Buffer)),
+        boost::bind(&CWorkClient::onRead, shared_from_this(), placeholders::error, placeholders::bytes_transferred));
+}
+
+void CWorkClient::onRead(const boost::system::error_code& Error, std::size_t NumBytes)
+{
+    if (Error)
+    {
+        if (Error != error::operation_aborted)
+            printf("WorkServer: solver %s disconnected\n", m_Stats.Address.c_str());
+        close();
+        return;
+    }
+
+    m_Reader.append(m_Buffer, NumBytes);
+    MotoMessage Msg;
+    while (m_Reader.next(Msg))
+        onMessage(Msg);
+    if (m_Reader.hasOverflowed())
+    {
+        printf("WorkServer: solver %s sent too long line, disconnecting\n", m_Stats.Address.c_str());
+        close();
+        return;
+    }
+    read();
+}
+
+void CWorkClient::onMessage(const MotoMessage& Msg)
+{
+    switch (Msg.Type)
+    {
+    case MOTO_MSG_HELLO:
+        // Hello is answered once, solver doesn't answer ours.
+        if (m_Subscribed || Msg.Version != MOTO_FRAME_VERSION)
+            break;
+        m_Subscribed = true;
+        send(motoHelloMessage());
+        if (!g_Jobs.empty())
+            send(motoFrame(g_Jobs.back().Id, g_Jobs.back().Work));
+        break;
+
+    case MOTO_MSG_SOLUTION:
+        submit(*this, Msg.JobId, Msg.PoW);
+        break;
+
+    default: // Abandoned jobs and text are of no interest.
+        break;
+    }
+}
+
+void CWorkClient::send(const std::string& Msg)
+{
+    if (!m_Socket.is_open())
+        return;
+    if (m_Output.size() >= g_MaxOutput)
+    {
+        printf("WorkServer: solver %s doesn't read work, disconnecting\n", m_Stats.Address.c_str());
+        close();
+        return;
+    }
+
+    m_Output.push_back(Msg);
+    if (m_Output.size() == 1)
+        async_write(m_Socket, buffer(m_Output.front()), boost::bind(&CWorkClient::onWrite, shared_from_this(), placeholders::error));
+}
+
+void CWorkClient::onWrite(const boost::system::error_code& Error)
+{
+    if (Error)
+    {
+        close();
+        return;
+    }
+
+    m_Output.pop_front();
+    if (!m_Output.empty())
+        async_write(m_Socket, buffer(m_Output.front()), boost::bind(&CWorkClient::onWrite, shared_from_this(), placeholders::error));
+}
+
+static void startAccept();
+
+static void onAccept(boost::shared_ptr<CWorkClient> pClient, const boost::system::error_code& Error)
+{
+    if (Error == error::operation_aborted)
+        return;
+    if (!Error)
+        pClient->start();
+    startAccept();
+}
+
+static void startAccept()
+{
+    boost::shared_ptr<CWorkClient> pClient(new CWorkClient);
+    g_Acceptor.async_accept(pClient->m_Socket, boost::bind(onAccept, pClient, placeholders::error));
+}
+
+static void startTimer();
+
+// Work is renewed periodically, new blocks are notified at once.
+static void everySecond(const boost::system::error_code& Error)
+{
+    if (Error == error::operation_aborted)
+        return;
+    updateWork();
+    startTimer();
+}
+
+static void startTimer()
+{
+    g_Timer.expires_from_now(boost::posix_time::seconds(1));
+    g_Timer.async_wait(everySecond);
+}
+
+static void onBlocksChanged()
+{
+    g_IOService.post(updateWork);
+}
+
+void startWorkServer()
+{
+    if (!GetBoolArg("-workserver") || !pwalletMain)
+        return;
+
+    try
+    {
+        g_pReserveKey = new CReserveKey(pwalletMain);
+
+        // Without -workserverallowip only local solvers may connect.
+        bool Loopback = !mapArgs.count("-workserverallowip");
+        ip::tcp::endpoint Endpoint(Loopback ? ip::address_v4::loopback() : ip::address_v4::any(),
+            GetArg("-workserverport", getDefaultWorkServerPort()));
+        g_Acceptor.open(Endpoint.protocol());
+        g_Acceptor.set_option(ip::tcp::acceptor::reuse_address(true));
+        g_Acceptor.bind(Endpoint);
+        g_Acceptor.listen();
+
+        startAccept();
+        startTimer();
+        g_BlocksChanged = uiInterface.NotifyBlocksChanged.connect(onBlocksChanged);
+
+        g_Thread = boost::thread(boost::bind((size_t (io_service::*)())&io_service::run, &g_IOService));
+        printf("WorkServer: listening on port %i\n", (int)Endpoint.port());
+    }
+    catch (std::exception& e)
+    {
+        printf("WorkServer, ERROR: %s\n", e.what());
+    }
+}
+
+void stopWorkServer()
+{
+    g_BlocksChanged.disconnect();
+    g_IOService.stop();
+    if (g_Thread.joinable())
+        g_Thread.join();
+
+    {
+        LOCK(g_csClients);
+        g_Clients.clear();
+    }
+    g_Jobs.clear();
+    delete g_pReserveKey;
+    g_pReserveKey = NULL;
+}
+
+std::vector<CWorkClientStats> getWorkServerStats()
+{
+    std::vector<CWorkClientStats> Stats;
+    LOCK(g_csClients);
+    BOOST_FOREACH(const boost::shared_ptr<CWorkClient>& pClient, g_Clients)
+        Stats.push_back(pClient->m_Stats);
+    return Stats;
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2014 The Motocoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+//--------------------------------------------------------------------
+// Work server for solvers on the same machine or LAN.
+//--------------------------------------------------------------------
+// Solvers (motosolver -connect=<host>:<port>) keep TCP connection to
+// the node. They speak binary framing of moto-protocol: solver sends
+// hello, node answers it and pushes work with job ID whenever tip
+// changes, solutions are sent back with job ID only.
+//--------------------------------------------------------------------
+
+#ifndef MOTOCOIN_WORKSERVER_H
+#define MOTOCOIN_WORKSERVER_H
+
+#include <string>
+#include <vector>
+#include "util.h"
+
+struct CWorkClientStats
+{
+    std::string Address;
+    int64 ConnectedTime;
+    int64 LastShareTime;
+    uint64 NumShares;  // Solutions that passed the check.
+    uint64 NumBlocks;  // Solutions that were accepted as blocks.
+    uint64 NumStale;   // Solutions of jobs that are not kept anymore.
+    uint64 NumInvalid; // Solutions that failed the check.
+};
+
+unsigned short getDefaultWorkServerPort();
+
+// Does nothing unless -workserver is given.
+void startWorkServer();
+void stopWorkServer();
+
+// Connected solvers.
+std::vector<CWorkClientStats> getWorkServerStats();
+
+#endif // MOTOCOIN_WORKSERVER_H